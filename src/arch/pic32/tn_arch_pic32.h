@@ -181,10 +181,10 @@ typedef  unsigned int               TN_UIntPtr;
 #define  TN_PRIORITIES_MAX_CNT      TN_INT_WIDTH
 
 /**
- * Value for infinite waiting, usually matches `ULONG_MAX`,
- * because `#TN_TickCnt` is declared as `unsigned long`.
+ * Value for infinite waiting: maximum value of `#TN_TickCnt`
+ * (its width is set by `#TN_TICK_CNT_WIDTH`).
  */
-#define  TN_WAIT_INFINITE           (TN_TickCnt)0xFFFFFFFF
+#define  TN_WAIT_INFINITE           ((TN_TickCnt)~(TN_TickCnt)0)
 
 /**
  * Value for initializing the task's stack
@@ -292,6 +292,12 @@ typedef  unsigned int               TN_UIntPtr;
 #define _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED()          \
    _tn_context_switch_pend_if_needed()
 
+/**
+ * Non-zero if `tn_arch_sched_dis_save()` disables the scheduler only, while
+ * other system interrupts may stay enabled.
+ */
+#define _TN_ARCH_SCHED_DIS_KEEPS_INT    1
+
 /**
  * Converts size in bytes to size in `#TN_UWord`.
  * For 32-bit platforms, we should shift it by 2 bit to the right;
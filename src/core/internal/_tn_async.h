@@ -0,0 +1,200 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef __TN_ASYNC_H
+#define __TN_ASYNC_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "_tn_sys.h"
+#include "tn_async.h"
+
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+#if TN_ASYNC_WAIT
+
+/*******************************************************************************
+ *    EXTERNAL TYPES
+ ******************************************************************************/
+
+
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Register asynchronous wait in the object's list of asynchronous waiters.
+ *
+ * Should be called with interrupts disabled.
+ *
+ * @param async_wait_queue
+ *    List of asynchronous waiters of some object
+ * @param wait
+ *    Waiter node to register; it must not be busy, see
+ *    `_tn_async_wait_is_busy()`.
+ */
+void _tn_async_wait_add(
+      struct TN_ListItem *async_wait_queue,
+      struct TN_AsyncWait *wait
+      );
+
+/**
+ * Complete the asynchronous wait: store the result, call completion
+ * callback (if any), and give the node to the completion object (if any).
+ * The node must not be included in the list of waiters at this point.
+ *
+ * Should be called with interrupts disabled.
+ *
+ * @param wait
+ *    Waiter node to complete
+ * @param rc
+ *    Result code to store in the node
+ * @param p_data
+ *    Result data to store in the node
+ */
+void _tn_async_wait_complete(
+      struct TN_AsyncWait *wait,
+      enum TN_RCode rc,
+      void *p_data
+      );
+
+/**
+ * If the list of asynchronous waiters is not empty, remove the first waiter
+ * from it and complete the wait by calling `_tn_async_wait_complete()`.
+ *
+ * Should be called with interrupts disabled.
+ *
+ * @param async_wait_queue
+ *    List of asynchronous waiters of some object
+ * @param rc
+ *    Result code to store in the node
+ * @param p_data
+ *    Result data to store in the node
+ *
+ * @return
+ *    - `TN_TRUE` if some wait was completed;
+ *    - `TN_FALSE` if the list is empty.
+ */
+TN_BOOL _tn_async_first_wait_complete(
+      struct TN_ListItem *async_wait_queue,
+      enum TN_RCode rc,
+      void *p_data
+      );
+
+/**
+ * Complete all the asynchronous waits from the list with `#TN_RC_DELETED`:
+ * called when the object is being deleted.
+ *
+ * Should be called with interrupts disabled.
+ *
+ * @param async_wait_queue
+ *    List of asynchronous waiters of the object being deleted
+ */
+void _tn_async_wait_queue_notify_deleted(
+      struct TN_ListItem *async_wait_queue
+      );
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED INLINE FUNCTIONS
+ ******************************************************************************/
+
+/**
+ * Checks whether given completion object is valid 
+ * (actually, just checks against `id_compl` field, see `enum #TN_ObjId`)
+ */
+_TN_STATIC_INLINE TN_BOOL _tn_async_compl_is_valid(
+      const struct TN_AsyncCompl *completion
+      )
+{
+   return (completion->id_compl == TN_ID_ASYNC_COMPL);
+}
+
+/**
+ * Returns whether the waiter node can't be given to the asynchronous wait
+ * function right now: either the wait is pending, or the completed node
+ * is still in the `done_list` of the completion object (its `queue_item`
+ * is in use until the node is taken by `tn_async_compl_wait()`).
+ *
+ * Should be called with interrupts disabled.
+ */
+_TN_STATIC_INLINE TN_BOOL _tn_async_wait_is_busy(
+      const struct TN_AsyncWait *wait
+      )
+{
+   return (wait->pending || wait->queued);
+}
+
+#endif // TN_ASYNC_WAIT
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+
+#endif // __TN_ASYNC_H
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
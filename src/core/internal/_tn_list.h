@@ -520,6 +520,19 @@ struct TN_ListItem *_tn_list_remove_tail(struct TN_ListItem *list);
  */
 void _tn_list_remove_entry(struct TN_ListItem *entry);
 
+/**
+ * Move all items from one list to another one, preserving their order.
+ * Previous contents of the destination list (if any) is discarded, and the
+ * source list becomes empty.
+ *
+ * @param dst
+ *    List to which items should be moved
+ *
+ * @param src
+ *    List from which items should be moved
+ */
+void _tn_list_move_all(struct TN_ListItem *dst, struct TN_ListItem *src);
+
 /**
  * Checks whether given item is contained in the list. Note that the list 
  * will be walked through from the beginning until the item is found, or
@@ -73,8 +73,17 @@ extern "C"  {     /*}*/
 #if TN_USE_MUTEXES
 /**
  * Unlock all mutexes locked by the task
+ *
+ * @param task
+ *    Task whose mutexes should be unlocked
+ * @param TN_INTSAVE_VAR
+ *    Status register value saved by the caller when it disabled interrupts,
+ *    see `_tn_sys_preempt_point()`.
  */
-void _tn_mutex_unlock_all_by_task(struct TN_Task *task);
+void _tn_mutex_unlock_all_by_task(
+      struct TN_Task *task,
+      TN_UWord TN_INTSAVE_VAR
+      );
 
 /**
  * Should be called when task finishes waiting
@@ -94,6 +103,18 @@ void _tn_mutex_i_on_task_wait_complete(struct TN_Task *task);
  */
 void _tn_mutex_on_task_wait_complete(struct TN_Task *task);
 
+#if TN_MUTEX_DEADLOCK_DETECT && TN_MUTEX_DEADLOCK_DETECT_DEFER
+/**
+ * Check tasks which started waiting for mutexes since the previous call
+ * for deadlock (see `#TN_MUTEX_DEADLOCK_DETECT_DEFER`). Should be called
+ * from the idle task with interrupts enabled: each task is checked in its
+ * own critical section.
+ */
+void _tn_mutex_deadlock_check_deferred(void);
+#else
+_TN_STATIC_INLINE void _tn_mutex_deadlock_check_deferred(void) {}
+#endif
+
 #else
 
 /*
@@ -101,8 +122,12 @@ void _tn_mutex_on_task_wait_complete(struct TN_Task *task);
  * are just compiled out.
  */
 
-_TN_STATIC_INLINE void _tn_mutex_unlock_all_by_task(struct TN_Task *task) {
+_TN_STATIC_INLINE void _tn_mutex_unlock_all_by_task(
+      struct TN_Task *task,
+      TN_UWord TN_INTSAVE_VAR
+      ) {
    (void) task;
+   (void) TN_INTSAVE_VAR;
 }
 _TN_STATIC_INLINE void _tn_mutex_i_on_task_wait_complete(struct TN_Task *task) {
    (void) task;
@@ -110,6 +135,7 @@ _TN_STATIC_INLINE void _tn_mutex_i_on_task_wait_complete(struct TN_Task *task) {
 _TN_STATIC_INLINE void _tn_mutex_on_task_wait_complete(struct TN_Task *task) {
    (void) task;
 }
+_TN_STATIC_INLINE void _tn_mutex_deadlock_check_deferred(void) {}
 #endif
 
 
@@ -89,6 +89,22 @@ extern volatile unsigned int _tn_ready_to_run_bmp;
 /// idle task structure
 extern struct TN_Task _tn_idle_task;
 
+#if TN_TIME_PARTITIONS
+/// bitmask of priorities which are eligible to run in the current time
+/// window (see `#TN_TIME_PARTITIONS`). It is applied to
+/// `_tn_ready_to_run_bmp` when looking for the next task to run.
+extern volatile unsigned int _tn_ready_to_run_mask;
+#endif
+
+/// Time slice values for each available priority, in system ticks.
+extern unsigned short _tn_tslice_ticks[TN_PRIORITIES_CNT];
+
+#if TN_LAZY_SCHED
+/// set when `_tn_next_task_to_run` might be out of date (see
+/// `#TN_LAZY_SCHED`)
+extern volatile TN_BOOL _tn_next_task_dirty;
+#endif
+
 
 
 
@@ -131,8 +147,66 @@ extern struct TN_Task _tn_idle_task;
 
 /**
  * Remove all tasks from wait queue, returning the TN_RC_DELETED code.
+ *
+ * @param wait_queue
+ *    Wait queue to remove tasks from
+ * @param TN_INTSAVE_VAR
+ *    Status register value saved by the caller when it disabled interrupts,
+ *    see `_tn_sys_preempt_point()`.
  */
-void _tn_wait_queue_notify_deleted(struct TN_ListItem *wait_queue);
+void _tn_wait_queue_notify_deleted(
+      struct TN_ListItem *wait_queue,
+      TN_UWord TN_INTSAVE_VAR
+      );
+
+#if TN_LAZY_SCHED
+/**
+ * Look for the next task to run, setting `_tn_next_task_to_run`, and clear
+ * `_tn_next_task_dirty` flag. Interrupts are disabled inside, so it may be
+ * called with interrupts either enabled or disabled.
+ *
+ * Use `_tn_next_task_resolve()` instead of calling it directly.
+ */
+void _tn_next_task_dirty_resolve(void);
+#endif
+
+#if TN_PREEMPT_POINT_ITEMS
+/**
+ * Preemption point for the kernel loops whose length depends on the number
+ * of tasks involved (see `#TN_PREEMPT_POINT_ITEMS`). Should be called with
+ * interrupts disabled, once per item handled: each
+ * `#TN_PREEMPT_POINT_ITEMS`-th call briefly restores interrupts to the state
+ * they had before the caller disabled them.
+ *
+ * The scheduler is disabled during this window, so, context switch can't
+ * happen there; but ISRs can, and they might modify the list being walked.
+ * So, after each call, the caller should get the next item from some
+ * location that stays valid: typically, the head of the list which holds
+ * items that aren't handled yet.
+ *
+ * In ISR context, it does nothing.
+ *
+ * @param p_items_cnt
+ *    Pointer to the items counter of the loop, it should be initialized
+ *    with 0 before the loop.
+ * @param TN_INTSAVE_VAR
+ *    Status register value saved by the caller when it disabled interrupts.
+ *    Interrupts are restored to this state, not just enabled: so, if the
+ *    kernel service was called with interrupts already disabled, they stay
+ *    disabled.
+ */
+void _tn_sys_preempt_point(int *p_items_cnt, TN_UWord TN_INTSAVE_VAR);
+#else
+_TN_STATIC_INLINE void _tn_sys_preempt_point(
+      int *p_items_cnt,
+      TN_UWord TN_INTSAVE_VAR
+      )
+{
+   _TN_UNUSED(p_items_cnt);
+   _TN_UNUSED(TN_INTSAVE_VAR);
+}
+#endif
+
 
 
 /**
@@ -173,6 +247,21 @@ enum TN_StateFlag _tn_sys_state_flags_clear(enum TN_StateFlag flags);
 void _tn_cry_deadlock(TN_BOOL active, struct TN_Mutex *mutex, struct TN_Task *task);
 #endif
 
+#if TN_MUTEX_CEIL_LEARN
+/**
+ * This function is called by the mutex subsystem when some task tries to
+ * lock the mutex with priority ceiling protocol while the task's base
+ * priority is higher than the ceiling. It calls user callback, if any.
+ *
+ * @param mutex
+ *    mutex whose ceiling is violated
+ *
+ * @param task
+ *    task that tried to lock the mutex
+ */
+void _tn_cry_mutex_ceil_violation(struct TN_Mutex *mutex, struct TN_Task *task);
+#endif
+
 
 #if _TN_ON_CONTEXT_SWITCH_HANDLER
 /**
@@ -201,15 +290,60 @@ void _tn_sys_on_context_switch(
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
 
+/**
+ * If `#TN_LAZY_SCHED` is non-zero and the scheduling decision is out of date,
+ * bring `_tn_next_task_to_run` up to date. Otherwise, does nothing.
+ *
+ * Should be called before `_tn_next_task_to_run` is read.
+ */
+_TN_STATIC_INLINE void _tn_next_task_resolve(void)
+{
+#if TN_LAZY_SCHED
+   if (_tn_next_task_dirty){
+      _tn_next_task_dirty_resolve();
+   }
+#endif
+}
+
+/**
+ * Should be called after the loop with preemption points (see
+ * `_tn_sys_preempt_point()`), before interrupts are enabled.
+ *
+ * If `#TN_LAZY_SCHED` is non-zero, some ISR might have pended context switch
+ * while interrupts were enabled in the preemption point, and then the loop
+ * might have made more tasks runnable, just marking the scheduling decision
+ * as out of date. Context switch happens as soon as interrupts are enabled,
+ * so, the decision has to be brought up to date right here.
+ */
+_TN_STATIC_INLINE void _tn_sys_preempt_points_done(void)
+{
+#if TN_PREEMPT_POINT_ITEMS && TN_LAZY_SCHED
+   _tn_next_task_resolve();
+#endif
+}
+
 /**
  * Checks whether context switch is needed (that is, if currently running task 
  * is not the highest-priority task in the $(TN_TASK_STATE_RUNNABLE) state)
  *
+ * If `#TN_PREEMPTIVE` is zero, the running task is switched out only when it
+ * is not runnable anymore (or when it is the idle task).
+ *
  * @return `#TN_TRUE` if context switch is needed
  */
 _TN_STATIC_INLINE TN_BOOL _tn_need_context_switch(void)
 {
+   _tn_next_task_resolve();
+
+#if TN_PREEMPTIVE
    return (_tn_curr_run_task != _tn_next_task_to_run);
+#else
+   return (_tn_curr_run_task != _tn_next_task_to_run)
+      && (0
+            || _tn_curr_run_task == &_tn_idle_task
+            || !(_tn_curr_run_task->task_state & TN_TASK_STATE_RUNNABLE)
+         );
+#endif
 }
 
 /**
@@ -94,6 +94,8 @@ extern "C"  {     /*}*/
  *
  * if priority of given `task` is higher than priority of
  * `_tn_next_task_to_run`, then set `_tn_next_task_to_run` to given `task`.
+ * (if `#TN_LAZY_SCHED` is non-zero, it just marks `_tn_next_task_to_run` as
+ * out of date instead)
  */
 void _tn_task_set_runnable(struct TN_Task *task);
 
@@ -102,7 +104,8 @@ void _tn_task_set_runnable(struct TN_Task *task);
  * Should be called when task_state has just single RUNNABLE bit set.
  *
  * Clear RUNNABLE bit, remove task from 'ready queue', determine and set
- * new `#_tn_next_task_to_run`.
+ * new `#_tn_next_task_to_run` (if `#TN_LAZY_SCHED` is non-zero, it just marks
+ * `_tn_next_task_to_run` as out of date instead).
  */
 void _tn_task_clear_runnable(struct TN_Task *task);
 
@@ -394,6 +397,44 @@ TN_UWord *_tn_task_stack_end_get(
       struct TN_Task *task
       );
 
+#if TN_FAIR_SHARE
+/**
+ * Move runnable task within the ready-to-run queue of its priority, so that
+ * the queue stays ordered by virtual run time (see `#TN_FAIR_SHARE`). The
+ * task is placed after all other tasks with the same or smaller virtual run
+ * time.
+ *
+ * Interrupts should be disabled when calling it.
+ */
+void _tn_task_fair_share_requeue(struct TN_Task *task);
+#endif
+
+#if TN_TIME_PARTITIONS
+/**
+ * Look for the highest-priority runnable task which is eligible in the
+ * current time window, and set `_tn_next_task_to_run` to it. Should be called
+ * whenever `_tn_ready_to_run_mask` is changed.
+ *
+ * Interrupts should be disabled when calling it.
+ */
+void _tn_task_next_to_run_find(void);
+#endif
+
+#if TN_STACK_FILL_LAZY
+/**
+ * Should be called from the idle task only. If there are tasks whose stacks
+ * aren't completely filled with `#TN_FILL_STACK_VAL` yet (see
+ * `#TN_STACK_FILL_LAZY`), fill next `#TN_STACK_FILL_GUARD_SIZE` words of
+ * stack of one of them. The part of the stack which is currently used by the
+ * task is never touched.
+ *
+ * Interrupts are disabled for the time of one chunk only.
+ *
+ * @return `TN_TRUE` if there are still stacks to fill, `TN_FALSE` otherwise.
+ */
+TN_BOOL _tn_task_stack_fill_lazy_step(void);
+#endif
+
 /*******************************************************************************
  *    PROTECTED INLINE FUNCTIONS
  ******************************************************************************/
@@ -67,6 +67,16 @@ extern "C"  {     /*}*/
  *    PROTECTED GLOBAL DATA
  ******************************************************************************/
 
+#if TN_TIMER_STAT
+/// Statistics of the timer engine, see `struct #TN_TimerStat`
+extern struct TN_TimerStat _tn_timer_stat;
+
+/// Time function given to `#tn_timer_stat_time_func_set()`, or `TN_NULL`
+extern TN_TimerStatTimeFunc *_tn_timer_stat_time_func;
+
+/// Time spent in timer callbacks during current tick
+extern TN_UWord _tn_timer_stat_cb_time_cur;
+#endif
 
 
 
@@ -101,6 +111,15 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR);
  */
 enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout);
 
+/**
+ * Actual worker function that is called by `#tn_timer_start_at()`.
+ * Interrupts should be disabled when calling it.
+ *
+ * It is implemented on top of `_tn_timer_start()`, so it works for both
+ * static and dynamic tick.
+ */
+enum TN_RCode _tn_timer_start_at(struct TN_Timer *timer, TN_TickCnt abs_tick);
+
 /**
  * Actual worker function that is called by `#tn_timer_cancel()`.
  * Interrupts should be disabled when calling it.
@@ -181,14 +200,87 @@ _TN_STATIC_INLINE void _tn_timer_callback_call(
    //   they aren't disabled for too long
    TN_INT_IRESTORE();
 
+#if TN_TIMER_STAT
+   TN_TimerStatTimeFunc *time_func = _tn_timer_stat_time_func;
+   TN_UWord cb_start = (time_func != TN_NULL) ? time_func() : 0;
+#endif
+
    //-- call user callback function
    timer->func(timer, p_user_data);
 
+#if TN_TIMER_STAT
+   if (time_func != TN_NULL){
+      cb_start = time_func() - cb_start;
+   }
+#endif
+
    //-- after callback is done, disable interrupts back
    //   (saved value won't be used by anyone though)
    TN_INT_IDIS_SAVE();
+
+#if TN_TIMER_STAT
+   if (time_func != TN_NULL){
+      _tn_timer_stat_cb_time_cur  += cb_start;
+      _tn_timer_stat.cb_time_total += cb_start;
+   }
+#endif
 }
 
+#if TN_TIMER_STAT
+/**
+ * Called by `_tn_timer_start()` of both timer engines: updates statistics
+ * with the timer being started with given timeout.
+ * Interrupts should be disabled when calling it.
+ */
+_TN_STATIC_INLINE void _tn_timer_stat_start(TN_TickCnt timeout)
+{
+   int idx = 0;
+
+   _tn_timer_stat.started_cnt++;
+
+   while ((timeout >>= 1) != 0 && idx < (TN_TIMER_STAT_HIST_CNT - 1)){
+      idx++;
+   }
+
+   _tn_timer_stat.timeout_hist[idx]++;
+}
+
+/**
+ * Called by `_tn_timers_tick_proceed()` of both timer engines after all
+ * expired timers are fired.
+ * Interrupts should be disabled when calling it.
+ *
+ * @param fired_cnt
+ *    Number of timers fired during this tick.
+ */
+_TN_STATIC_INLINE void _tn_timer_stat_tick_done(unsigned long fired_cnt)
+{
+   _tn_timer_stat.ticks_cnt++;
+   _tn_timer_stat.fired_cnt += fired_cnt;
+
+   if (fired_cnt > _tn_timer_stat.fired_per_tick_max){
+      _tn_timer_stat.fired_per_tick_max = fired_cnt;
+   }
+
+   if (_tn_timer_stat_cb_time_cur > _tn_timer_stat.cb_time_max){
+      _tn_timer_stat.cb_time_max = _tn_timer_stat_cb_time_cur;
+   }
+
+   _tn_timer_stat_cb_time_cur = 0;
+}
+
+/**
+ * Updates maximum length of the "generic" timers list, see
+ * `gen_list_len_max` in the `struct #TN_TimerStat`.
+ */
+_TN_STATIC_INLINE void _tn_timer_stat_gen_len(unsigned long len)
+{
+   if (len > _tn_timer_stat.gen_list_len_max){
+      _tn_timer_stat.gen_list_len_max = len;
+   }
+}
+#endif
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
@@ -79,6 +79,14 @@ extern TN_CBTickSchedule      *_tn_cb_tick_schedule;
 /// See `#TN_CBTickCntGet` for the prototype.
 extern TN_CBTickCntGet        *_tn_cb_tick_cnt_get;
 
+#if TN_IDLE_GOVERNOR
+///
+/// Ticks which were missed by the tick counter while MCU was in the sleep
+/// state which stops it (see `TN_SleepState::tick_stopped`). It is added to
+/// the value returned by `_tn_cb_tick_cnt_get()`.
+extern TN_TickCnt             _tn_tick_compensation;
+#endif
+
 
 
 
@@ -103,6 +111,23 @@ void _tn_timer_dyn_callback_set(
       TN_CBTickCntGet     *cb_tick_cnt_get
       );
 
+#if TN_IDLE_GOVERNOR
+/**
+ * Get time until the nearest timer expiration: `0` if it is already
+ * expired, or `#TN_WAIT_INFINITE` if there are no active timers.
+ * Interrupts should be disabled when calling it.
+ */
+TN_TickCnt _tn_timer_next_timeout_get(void);
+
+/**
+ * Add `ticks` to the system tick count (see `_tn_tick_compensation`), and
+ * tell the application when `tn_tick_int_processing()` should be called
+ * next time (this might be "right now", if some timers expired).
+ * Interrupts should be disabled when calling it.
+ */
+void _tn_timer_tick_compensate(TN_TickCnt ticks);
+#endif
+
 
 
 
@@ -116,7 +141,11 @@ void _tn_timer_dyn_callback_set(
  */
 _TN_STATIC_INLINE TN_TickCnt _tn_timer_sys_time_get(void)
 {
+#if TN_IDLE_GOVERNOR
+   return (TN_TickCnt)(_tn_cb_tick_cnt_get() + _tn_tick_compensation);
+#else
    return _tn_cb_tick_cnt_get();
+#endif
 }
 
 
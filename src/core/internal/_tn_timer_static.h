@@ -88,6 +88,23 @@ extern volatile TN_TickCnt _tn_sys_time_count;
  *    PROTECTED FUNCTION PROTOTYPES
  ******************************************************************************/
 
+#if TN_HYBRID_TICK
+/**
+ * Get time until the nearest timer expiration, or `#TN_WAIT_INFINITE` if
+ * there are no active timers. Interrupts should be disabled when calling it.
+ */
+TN_TickCnt _tn_timer_next_timeout_get(void);
+
+/**
+ * Advance the system tick count by `ticks` at once, as if the tick
+ * interrupt was handled `ticks` times (see `#TN_HYBRID_TICK`). No timer
+ * should expire during these ticks, i.e. `ticks` should be less than the
+ * value returned by `_tn_timer_next_timeout_get()`. Interrupts should be
+ * disabled when calling it.
+ */
+void _tn_timer_tick_catch_up(TN_TickCnt ticks);
+#endif
+
 
 
 
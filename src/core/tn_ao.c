@@ -0,0 +1,798 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+#include "_tn_tasks.h"
+
+
+//-- header of current module
+#include "_tn_ao.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+#include "tn_dqueue.h"
+#include "tn_fmem.h"
+#include "tn_timer.h"
+
+
+#if TN_ACTIVE_OBJECTS
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+//-- Active objects by their indexes in subscriber masks
+static struct TN_ActiveObj *_ao_registry[ TN_AO_MAX_CNT ];
+
+//-- Subscriber masks given to tn_ao_pubsub_init(), one per signal
+static unsigned int *_subscr_masks = TN_NULL;
+
+//-- Number of items in _subscr_masks
+static int _signals_cnt = 0;
+
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_ActiveObj *ao
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (ao == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_ao_is_valid(ao)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating active object
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_ActiveObj *ao,
+      TN_AODispatch *dispatch,
+      int queue_size
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (ao == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (0
+         || _tn_ao_is_valid(ao)
+         || dispatch == TN_NULL
+         || queue_size <= 0
+         )
+   {
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking of the event
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_event(
+      const struct TN_AOEvent *event
+      )
+{
+   return (event == TN_NULL) ? TN_RC_WPARAM : TN_RC_OK;
+}
+
+/**
+ * Additional param checking of the signal which can be published
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_sig(int sig)
+{
+   return (sig < 0 || sig >= _signals_cnt) ? TN_RC_WPARAM : TN_RC_OK;
+}
+
+#else
+#  define _check_param_generic(ao)                             (TN_RC_OK)
+#  define _check_param_create(ao, dispatch, queue_size)        (TN_RC_OK)
+#  define _check_param_event(event)                            (TN_RC_OK)
+#  define _check_param_sig(sig)                                (TN_RC_OK)
+#endif
+// }}}
+
+
+//-- Event references {{{
+
+/**
+ * Add reference to the event: it is done for each AO queue that gets the
+ * event.
+ */
+static void _event_ref(struct TN_AOEvent *event)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   event->ref_cnt++;
+   tn_arch_sr_restore(sr_saved);
+}
+
+/**
+ * Drop reference to the event; if it was the last reference to the dynamic
+ * event, return the event to its pool.
+ */
+static void _event_unref(struct TN_AOEvent *event)
+{
+   TN_BOOL garbage;
+
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   event->ref_cnt--;
+   garbage = (event->ref_cnt == 0 && event->pool != TN_NULL);
+   tn_arch_sr_restore(sr_saved);
+
+   if (garbage){
+      if (tn_is_isr_context()){
+         tn_fmem_irelease(event->pool, (void *)event);
+      } else {
+         tn_fmem_release(event->pool, (void *)event);
+      }
+   }
+}
+
+// }}}
+
+
+/**
+ * Post the event to the AO queue without waiting, and update AO statistics
+ */
+static enum TN_RCode _ao_post(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event,
+      TN_BOOL is_isr
+      )
+{
+   enum TN_RCode rc;
+   TN_UWord sr_saved;
+
+   //-- the reference should be added before the event is sent: the AO
+   //   might dispatch (and unref) the event before send function returns
+   _event_ref(event);
+   event->post_time = tn_sys_time_get();
+
+   if (is_isr){
+      rc = tn_queue_isend_polling(&ao->queue, (void *)event);
+   } else {
+      rc = tn_queue_send_polling(&ao->queue, (void *)event);
+   }
+
+   sr_saved = tn_arch_sr_save_int_dis();
+   if (rc != TN_RC_OK){
+      ao->stat.post_fail_cnt++;
+   } else if (ao->queue.filled_items_cnt > ao->stat.queue_depth_max){
+      ao->stat.queue_depth_max = ao->queue.filled_items_cnt;
+   }
+   tn_arch_sr_restore(sr_saved);
+
+   if (rc != TN_RC_OK){
+      _event_unref(event);
+   }
+
+   return rc;
+}
+
+/**
+ * Post the event to each subscriber of its signal
+ */
+static enum TN_RCode _ao_publish(
+      struct TN_AOEvent *event,
+      TN_BOOL is_isr
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   unsigned int mask = _subscr_masks[ event->sig ];
+   int idx;
+
+   //-- hold the event while it is being posted, so that it isn't freed
+   //   by the subscriber which is done with it before others get it.
+   //   If nobody gets the event, it is freed when this reference is dropped.
+   _event_ref(event);
+
+   for (idx = 0; mask != 0; idx++, mask >>= 1){
+      struct TN_ActiveObj *ao = _ao_registry[ idx ];
+
+      if ((mask & 1) && ao != TN_NULL){
+         if (_ao_post(ao, event, is_isr) != TN_RC_OK){
+            rc = TN_RC_TIMEOUT;
+         }
+      }
+   }
+
+   _event_unref(event);
+
+   return rc;
+}
+
+/**
+ * Set or clear the AO bit in the subscriber mask of the signal
+ */
+static enum TN_RCode _ao_subscr_set(
+      struct TN_ActiveObj *ao,
+      int sig,
+      TN_BOOL subscribe
+      )
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (_subscr_masks == TN_NULL){
+      rc = TN_RC_WSTATE;
+   } else if ((rc = _check_param_sig(sig)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+      if (subscribe){
+         _subscr_masks[ sig ] |= (1u << ao->idx);
+      } else {
+         _subscr_masks[ sig ] &= ~(1u << ao->idx);
+      }
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/**
+ * Take a free index in the subscriber masks for the AO
+ */
+static enum TN_RCode _ao_register(struct TN_ActiveObj *ao)
+{
+   enum TN_RCode rc = TN_RC_OVERFLOW;
+   int idx;
+
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   for (idx = 0; idx < TN_AO_MAX_CNT; idx++){
+      if (_ao_registry[ idx ] == TN_NULL){
+         _ao_registry[ idx ] = ao;
+         ao->idx = idx;
+         rc = TN_RC_OK;
+         break;
+      }
+   }
+   tn_arch_sr_restore(sr_saved);
+
+   return rc;
+}
+
+/**
+ * Free the index of the AO, and unsubscribe it from all the signals
+ */
+static void _ao_unregister(struct TN_ActiveObj *ao)
+{
+   int sig;
+
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   _ao_registry[ ao->idx ] = TN_NULL;
+   for (sig = 0; sig < _signals_cnt; sig++){
+      _subscr_masks[ sig ] &= ~(1u << ao->idx);
+   }
+   tn_arch_sr_restore(sr_saved);
+}
+
+/**
+ * Give the event to the dispatch function of the AO, and then drop the
+ * reference to the event
+ */
+static void _ao_dispatch(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event
+      )
+{
+   TN_TickCnt latency = tn_sys_time_get() - event->post_time;
+
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   ao->stat.dispatch_cnt++;
+   if (latency > ao->stat.latency_max){
+      ao->stat.latency_max = latency;
+   }
+   tn_arch_sr_restore(sr_saved);
+
+   ao->dispatch(ao, event);
+
+   _event_unref(event);
+}
+
+/**
+ * Body of the AO task: wait for the event, and then dispatch all the pending
+ * events in a row, until the queue is empty.
+ */
+static void _ao_task_body(void *param)
+{
+   struct TN_ActiveObj *ao = (struct TN_ActiveObj *)param;
+   void *p_data;
+
+   for (;;){
+      if (tn_queue_receive(&ao->queue, &p_data, TN_WAIT_INFINITE)
+            == TN_RC_OK)
+      {
+         do {
+            _ao_dispatch(ao, (struct TN_AOEvent *)p_data);
+         } while (tn_queue_receive_polling(&ao->queue, &p_data) == TN_RC_OK);
+      }
+   }
+}
+
+/**
+ * Returns whether the AO task waits for new events in its queue, i.e. it
+ * neither holds nor dispatches any event, so it can be terminated safely.
+ * Should be called with interrupts disabled.
+ */
+static TN_BOOL _ao_task_is_idle(struct TN_ActiveObj *ao)
+{
+   return (
+            _tn_task_is_waiting(&ao->task)
+         && ao->task.task_wait_reason == TN_WAIT_REASON_DQUE_WRECEIVE
+         && ao->task.pwait_queue == &ao->queue.wait_receive_list
+         );
+}
+
+/**
+ * Timer function of the time event: post the event, and restart the timer
+ * if the time event is periodic
+ */
+static void _time_event_timer_func(struct TN_Timer *timer, void *p_user_data)
+{
+   struct TN_AOTimeEvent *tevt = (struct TN_AOTimeEvent *)p_user_data;
+   TN_TickCnt interval = tevt->interval;
+
+   _ao_post(tevt->ao, &tevt->super, TN_TRUE);
+
+   if (interval != 0){
+      tn_timer_start(timer, interval);
+   }
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_create(
+      struct TN_ActiveObj    *ao,
+      TN_AODispatch          *dispatch,
+      int                     priority,
+      TN_UWord               *task_stack_low_addr,
+      int                     task_stack_size,
+      void                  **data_fifo,
+      int                     queue_size
+      )
+{
+   enum TN_RCode rc = _check_param_create(ao, dispatch, queue_size);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else if ((rc = _ao_register(ao)) != TN_RC_OK){
+      //-- no free index: just return rc as it is
+   } else if (
+         (rc = tn_queue_create(&ao->queue, data_fifo, queue_size)) 
+         != TN_RC_OK
+         )
+   {
+      _ao_unregister(ao);
+   } else {
+      ao->dispatch = dispatch;
+      ao->stat.queue_depth_max = 0;
+      ao->stat.latency_max = 0;
+      ao->stat.dispatch_cnt = 0;
+      ao->stat.post_fail_cnt = 0;
+
+      //-- AO should be valid before its task starts: it might preempt us
+      ao->id_ao = TN_ID_ACTIVE_OBJ;
+
+      rc = tn_task_create(
+            &ao->task, _ao_task_body, priority,
+            task_stack_low_addr, task_stack_size,
+            (void *)ao, TN_TASK_CREATE_OPT_START
+            );
+
+      if (rc != TN_RC_OK){
+         ao->id_ao = TN_ID_NONE;
+         tn_queue_delete(&ao->queue);
+         _ao_unregister(ao);
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_delete(struct TN_ActiveObj *ao)
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context() || tn_cur_task_get() == &ao->task){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      //-- the AO task can be terminated only while it waits for events:
+      //   otherwise it might hold the event taken from the queue, and
+      //   this event would never be released. Interrupts are disabled
+      //   so that the task can't get an event until it's terminated.
+      TN_INT_DIS_SAVE();
+
+      if (!_ao_task_is_idle(ao)){
+         rc = TN_RC_WSTATE;
+      } else {
+         //-- stop new events from being published to the AO
+         _ao_unregister(ao);
+         tn_task_terminate(&ao->task);
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+
+      if (rc == TN_RC_OK){
+         void *p_data;
+
+         tn_task_delete(&ao->task);
+
+         //-- release pending events
+         while (tn_queue_receive_polling(&ao->queue, &p_data) == TN_RC_OK){
+            _event_unref((struct TN_AOEvent *)p_data);
+         }
+
+         tn_queue_delete(&ao->queue);
+
+         ao->id_ao = TN_ID_NONE; //-- active object does not exist now
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+void tn_ao_event_static_init(struct TN_AOEvent *event, int sig)
+{
+   event->sig = sig;
+   event->pool = TN_NULL;
+   event->ref_cnt = 0;
+   event->post_time = 0;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_event_new(
+      struct TN_FMem *pool,
+      int sig,
+      struct TN_AOEvent **pp_event
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   void *p_data;
+
+   if (pool == TN_NULL || pp_event == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if ((rc = tn_fmem_get_polling(pool, &p_data)) == TN_RC_OK){
+      tn_ao_event_static_init((struct TN_AOEvent *)p_data, sig);
+      ((struct TN_AOEvent *)p_data)->pool = pool;
+      *pp_event = (struct TN_AOEvent *)p_data;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_ievent_new(
+      struct TN_FMem *pool,
+      int sig,
+      struct TN_AOEvent **pp_event
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   void *p_data;
+
+   if (pool == TN_NULL || pp_event == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if ((rc = tn_fmem_iget_polling(pool, &p_data)) == TN_RC_OK){
+      tn_ao_event_static_init((struct TN_AOEvent *)p_data, sig);
+      ((struct TN_AOEvent *)p_data)->pool = pool;
+      *pp_event = (struct TN_AOEvent *)p_data;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_post(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event
+      )
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if ((rc = _check_param_event(event)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      rc = _ao_post(ao, event, TN_FALSE);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_ipost(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event
+      )
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if ((rc = _check_param_event(event)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      rc = _ao_post(ao, event, TN_TRUE);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_pubsub_init(
+      unsigned int *subscr_masks,
+      int signals_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (subscr_masks == TN_NULL || signals_cnt <= 0){
+      rc = TN_RC_WPARAM;
+   } else {
+      int sig;
+
+      for (sig = 0; sig < signals_cnt; sig++){
+         subscr_masks[ sig ] = 0;
+      }
+
+      _signals_cnt = signals_cnt;
+      _subscr_masks = subscr_masks;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_subscribe(struct TN_ActiveObj *ao, int sig)
+{
+   return _ao_subscr_set(ao, sig, TN_TRUE);
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_unsubscribe(struct TN_ActiveObj *ao, int sig)
+{
+   return _ao_subscr_set(ao, sig, TN_FALSE);
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_publish(struct TN_AOEvent *event)
+{
+   enum TN_RCode rc = _check_param_event(event);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (_subscr_masks == TN_NULL){
+      rc = TN_RC_WSTATE;
+   } else if ((rc = _check_param_sig(event->sig)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      //-- lock the scheduler, so that subscribers don't preempt us one by
+      //   one: they start running when all of them have got the event.
+      TN_UWord sched_state = tn_sched_dis_save();
+      rc = _ao_publish(event, TN_FALSE);
+      tn_sched_restore(sched_state);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_ipublish(struct TN_AOEvent *event)
+{
+   enum TN_RCode rc = _check_param_event(event);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (_subscr_masks == TN_NULL){
+      rc = TN_RC_WSTATE;
+   } else if ((rc = _check_param_sig(event->sig)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      rc = _ao_publish(event, TN_TRUE);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_time_event_create(
+      struct TN_AOTimeEvent *tevt,
+      struct TN_ActiveObj *ao,
+      int sig
+      )
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (tevt == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+      tn_ao_event_static_init(&tevt->super, sig);
+      tevt->ao = ao;
+      tevt->interval = 0;
+
+      rc = tn_timer_create(
+            &tevt->timer, _time_event_timer_func, (void *)tevt
+            );
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_time_event_arm(
+      struct TN_AOTimeEvent *tevt,
+      TN_TickCnt timeout,
+      TN_TickCnt interval
+      )
+{
+   tevt->interval = interval;
+   return tn_timer_start(&tevt->timer, timeout);
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_time_event_disarm(struct TN_AOTimeEvent *tevt)
+{
+   //-- clear interval first, so that the timer function which is possibly
+   //   running right now doesn't restart the timer
+   tevt->interval = 0;
+   return tn_timer_cancel(&tevt->timer);
+}
+
+/*
+ * See comments in the header file (tn_ao.h)
+ */
+enum TN_RCode tn_ao_stat_get(
+      struct TN_ActiveObj *ao,
+      struct TN_AOStat *p_stat,
+      TN_BOOL reset
+      )
+{
+   enum TN_RCode rc = _check_param_generic(ao);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (p_stat == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      *p_stat = ao->stat;
+
+      if (reset){
+         ao->stat.queue_depth_max = 0;
+         ao->stat.latency_max = 0;
+         ao->stat.dispatch_cnt = 0;
+         ao->stat.post_fail_cnt = 0;
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+
+#endif // TN_ACTIVE_OBJECTS
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,606 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Active objects: event-driven tasks built on top of kernel queues, memory
+ * pools and timers.
+ *
+ * An active object (AO) is a task that owns an event queue and a dispatch
+ * function. The task body is provided by the kernel: it waits for the
+ * events and passes each of them to the dispatch function, one by one. The
+ * dispatch function should never block: it processes the event and returns
+ * (run-to-completion). So, the state of the AO is accessed by its own task
+ * only, and it needs no locking.
+ *
+ * Events are described by `struct #TN_AOEvent`, which user embeds as the
+ * first member of their own event structures:
+ *
+ * \code{.c}
+ * struct MyAdcEvent {
+ *    struct TN_AOEvent super;
+ *    int value;
+ * };
+ * \endcode
+ *
+ * Events are immutable once posted: the same event may be delivered to
+ * several AOs, so nobody should modify it. Events are either static (they
+ * live forever, and are never freed), or allocated from the fixed memory
+ * pool by `tn_ao_event_new()`. Dynamic events are reference-counted: each
+ * AO queue that holds the event owns a reference, and when the last AO is
+ * done with the event, the block is returned to its pool.
+ *
+ * Events are delivered either directly, by `tn_ao_post()`, or by
+ * `tn_ao_publish()`: each AO that \ref tn_ao_subscribe() "subscribed" to
+ * the event's signal gets it. Publishing from the task locks the scheduler
+ * for the time of posting, so that subscribers start processing the event
+ * in priority order after the whole delivery is done, and the context is
+ * switched at most once.
+ *
+ * Time events (`struct #TN_AOTimeEvent`) are static events that are posted
+ * to the AO by the kernel timer, once or periodically.
+ *
+ * Each AO gathers statistics: maximum queue depth, maximum latency from
+ * posting of the event to its dispatching, and so on. See `struct
+ * #TN_AOStat`.
+ *
+ * Available if only `#TN_ACTIVE_OBJECTS` is non-zero.
+ */
+
+#ifndef _TN_AO_H
+#define _TN_AO_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_common.h"
+#include "tn_tasks.h"
+#include "tn_dqueue.h"
+#include "tn_fmem.h"
+#include "tn_timer.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+#if TN_ACTIVE_OBJECTS || DOXYGEN_ACTIVE
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+struct TN_ActiveObj;
+
+/**
+ * Event: base structure that user embeds as the first member of their own
+ * event structures. Refer to the file description for details.
+ */
+struct TN_AOEvent {
+   ///
+   /// Signal: user-defined event type. If event is published (see
+   /// `tn_ao_publish()`), signal should be in the range `[0,
+   /// signals_cnt)`, where `signals_cnt` is given to `tn_ao_pubsub_init()`.
+   int sig;
+   ///
+   /// Pool the event is allocated from, or `TN_NULL` for static events.
+   struct TN_FMem *pool;
+   ///
+   /// Number of references to the event held by AO queues.
+   volatile int ref_cnt;
+   ///
+   /// System tick count at which the event was posted last time: used
+   /// to calculate dispatch latency.
+   TN_TickCnt post_time;
+};
+
+/**
+ * Dispatch function of the active object: it is called by the AO task for
+ * each event, and it should return as soon as the event is processed,
+ * without blocking.
+ *
+ * The event is owned by the kernel: after dispatch function returns, the
+ * event might be freed. If user wants to keep the event for later, they
+ * should allocate a new one and copy data there.
+ *
+ * @param ao
+ *    Active object that received the event
+ * @param event
+ *    The event to process
+ */
+typedef void (TN_AODispatch)(
+      struct TN_ActiveObj *ao,
+      const struct TN_AOEvent *event
+      );
+
+/**
+ * Active object statistics, see `tn_ao_stat_get()`.
+ */
+struct TN_AOStat {
+   ///
+   /// Maximum number of events that were pending in the AO queue
+   int queue_depth_max;
+   ///
+   /// Maximum number of system ticks elapsed since the event was posted
+   /// until it was given to the dispatch function
+   TN_TickCnt latency_max;
+   ///
+   /// How many events were dispatched
+   unsigned long dispatch_cnt;
+   ///
+   /// How many events weren't posted because the AO queue was full
+   unsigned long post_fail_cnt;
+};
+
+/**
+ * Active object
+ */
+struct TN_ActiveObj {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_ao;
+   ///
+   /// Task that dispatches events
+   struct TN_Task task;
+   ///
+   /// Queue of pending events
+   struct TN_DQueue queue;
+   ///
+   /// User-provided dispatch function
+   TN_AODispatch *dispatch;
+   ///
+   /// Index of the AO in the subscriber masks, see `tn_ao_subscribe()`
+   int idx;
+   ///
+   /// Statistics, see `tn_ao_stat_get()`
+   struct TN_AOStat stat;
+};
+
+/**
+ * Time event: static event which is posted to the AO by the kernel timer.
+ * See `tn_ao_time_event_arm()`.
+ */
+struct TN_AOTimeEvent {
+   ///
+   /// Event which is posted
+   struct TN_AOEvent super;
+   ///
+   /// Active object to post event to
+   struct TN_ActiveObj *ao;
+   ///
+   /// Timer which posts the event
+   struct TN_Timer timer;
+   ///
+   /// Period in system ticks, or 0 for one-shot time events
+   volatile TN_TickCnt interval;
+};
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * Max number of active objects that may exist at the same time: each of them
+ * takes one bit in the subscriber masks.
+ */
+#define  TN_AO_MAX_CNT     TN_INT_WIDTH
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Construct the active object, and start its task.
+ *
+ * `id_ao` field should not contain `#TN_ID_ACTIVE_OBJ`, otherwise,
+ * `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao
+ *    Pointer to already allocated `struct TN_ActiveObj`
+ * @param dispatch
+ *    Dispatch function, see `#TN_AODispatch`
+ * @param priority
+ *    Priority of the AO task, refer to `tn_task_create()`
+ * @param task_stack_low_addr
+ *    Stack of the AO task, refer to `tn_task_create()`
+ * @param task_stack_size
+ *    Size of the stack, refer to `tn_task_create()`
+ * @param data_fifo
+ *    Storage for the event queue: array of `queue_size` pointers
+ * @param queue_size
+ *    Capacity of the event queue, should be more than 0
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_OVERFLOW` if there are already `#TN_AO_MAX_CNT` active
+ *      objects;
+ *    * Return codes of `tn_task_create()` and `tn_queue_create()`;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_ao_create(
+      struct TN_ActiveObj    *ao,
+      TN_AODispatch          *dispatch,
+      int                     priority,
+      TN_UWord               *task_stack_low_addr,
+      int                     task_stack_size,
+      void                  **data_fifo,
+      int                     queue_size
+      );
+
+/**
+ * Destruct the active object: its task is terminated and deleted, the
+ * pending events are released, and the AO is unsubscribed from all the
+ * signals.
+ *
+ * The AO can be deleted only while its task waits for new events: if it's
+ * dispatching an event (or it's preempted right after it has taken the
+ * event from the queue), the event would never be released, so
+ * `#TN_RC_WSTATE` is returned and the AO is left intact. Typically, the AO
+ * is deleted by the task with lower priority than that of the AO.
+ *
+ * Should not be called by the task of the AO being deleted.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao      active object to destruct
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context, or by the AO itself;
+ *    * `#TN_RC_WSTATE` if the AO task doesn't wait for new events;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_delete(struct TN_ActiveObj *ao);
+
+/**
+ * Initialize static event: after that, the event may be posted or published
+ * any number of times, it is never freed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param event   event to initialize
+ * @param sig     signal of the event
+ */
+void tn_ao_event_static_init(struct TN_AOEvent *event, int sig);
+
+/**
+ * Allocate new event from the fixed memory pool, without waiting. The pool
+ * block size should be large enough to hold user's event structure.
+ *
+ * After the event is filled by the caller, it should be given away by
+ * `tn_ao_post()` or `tn_ao_publish()`; from that point, the event belongs
+ * to the kernel, and it is returned to the pool when the last AO has
+ * dispatched it.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param pool
+ *    Pool to allocate event from
+ * @param sig
+ *    Signal of the event
+ * @param pp_event
+ *    Pointer to where the event pointer should be stored
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_TIMEOUT` if there is no free block in the pool;
+ *    * Other return codes of `tn_fmem_get_polling()`;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_ao_event_new(
+      struct TN_FMem *pool,
+      int sig,
+      struct TN_AOEvent **pp_event
+      );
+
+/**
+ * The same as `tn_ao_event_new()`, but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_ao_ievent_new(
+      struct TN_FMem *pool,
+      int sig,
+      struct TN_AOEvent **pp_event
+      );
+
+/**
+ * Post event directly to the active object, without waiting.
+ *
+ * If the AO queue is full, the event isn't posted: `post_fail_cnt` of the
+ * AO statistics is incremented, and if the event is dynamic and nobody
+ * else holds it, it is returned to its pool.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao      active object to post event to
+ * @param event   event to post
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_TIMEOUT` if the AO queue is full;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_post(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event
+      );
+
+/**
+ * The same as `tn_ao_post()`, but for using in the ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_ao_ipost(
+      struct TN_ActiveObj *ao,
+      struct TN_AOEvent *event
+      );
+
+/**
+ * Initialize publish-subscribe: should be called once, before any
+ * `tn_ao_subscribe()` or `tn_ao_publish()` call.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param subscr_masks
+ *    Array of `signals_cnt` subscriber masks, one per signal. Each bit in
+ *    the mask corresponds to the active object. The array is cleared by
+ *    this function.
+ * @param signals_cnt
+ *    Number of signals that can be published
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_ao_pubsub_init(
+      unsigned int *subscr_masks,
+      int signals_cnt
+      );
+
+/**
+ * Subscribe the active object to the signal: after that, each event with
+ * this signal given to `tn_ao_publish()` is posted to the AO.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao      active object to subscribe
+ * @param sig     signal to subscribe to
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WSTATE` if `tn_ao_pubsub_init()` wasn't called;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_subscribe(struct TN_ActiveObj *ao, int sig);
+
+/**
+ * Unsubscribe the active object from the signal. Events already posted
+ * to the AO are still dispatched.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao      active object to unsubscribe
+ * @param sig     signal to unsubscribe from
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WSTATE` if `tn_ao_pubsub_init()` wasn't called;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_unsubscribe(struct TN_ActiveObj *ao, int sig);
+
+/**
+ * Publish the event: post it to each active object subscribed to its
+ * signal. Scheduler is locked while the event is being posted, so that
+ * context is switched at most once, when all subscribers have got the
+ * event.
+ *
+ * If some subscriber's queue is full, it doesn't get the event (and its
+ * `post_fail_cnt` is incremented), but other subscribers still do. If
+ * nobody has got the dynamic event, it is returned to its pool.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param event   event to publish
+ *
+ * @return
+ *    * `#TN_RC_OK` if all the subscribers have got the event (including the
+ *      case when there are no subscribers at all);
+ *    * `#TN_RC_TIMEOUT` if queue of some subscriber was full;
+ *    * `#TN_RC_WSTATE` if `tn_ao_pubsub_init()` wasn't called;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_ao_publish(struct TN_AOEvent *event);
+
+/**
+ * The same as `tn_ao_publish()`, but for using in the ISR. Scheduler isn't
+ * locked here, since context switch is postponed until the ISR returns
+ * anyway.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_ao_ipublish(struct TN_AOEvent *event);
+
+/**
+ * Construct the time event. Its static event with the signal `sig` will be
+ * posted to `ao`, see `tn_ao_time_event_arm()`.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param tevt    pointer to already allocated `struct TN_AOTimeEvent`
+ * @param ao      active object to post event to
+ * @param sig     signal of the event
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * Return codes of `tn_timer_create()`;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_time_event_create(
+      struct TN_AOTimeEvent *tevt,
+      struct TN_ActiveObj *ao,
+      int sig
+      );
+
+/**
+ * Arm (or re-arm) the time event: its event will be posted to the AO after
+ * `timeout` system ticks, and then, if `interval` is non-zero, each
+ * `interval` ticks until the time event is disarmed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param tevt       time event to arm
+ * @param timeout    timeout for the first posting, refer to
+ *                   `tn_timer_start()`
+ * @param interval   period for subsequent postings, or 0 for one-shot
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * Return codes of `tn_timer_start()`.
+ */
+enum TN_RCode tn_ao_time_event_arm(
+      struct TN_AOTimeEvent *tevt,
+      TN_TickCnt timeout,
+      TN_TickCnt interval
+      );
+
+/**
+ * Disarm the time event. If the event was already posted but isn't yet
+ * dispatched, it will still be dispatched.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param tevt       time event to disarm
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * Return codes of `tn_timer_cancel()`.
+ */
+enum TN_RCode tn_ao_time_event_disarm(struct TN_AOTimeEvent *tevt);
+
+/**
+ * Get statistics of the active object.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param ao         active object
+ * @param p_stat     pointer to where statistics should be stored
+ * @param reset      if `TN_TRUE`, statistics is reset after reading
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ao_stat_get(
+      struct TN_ActiveObj *ao,
+      struct TN_AOStat *p_stat,
+      TN_BOOL reset
+      );
+
+#endif // TN_ACTIVE_OBJECTS
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_AO_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -0,0 +1,445 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_list.h"
+
+
+//-- header of current module
+#include "_tn_async.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_ASYNC_WAIT
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_AsyncCompl *completion
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (completion == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_async_compl_is_valid(completion)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_AsyncCompl *completion
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (completion == TN_NULL || _tn_async_compl_is_valid(completion)){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_wait(
+      const struct TN_AsyncWait *wait
+      )
+{
+   return (wait == TN_NULL) ? TN_RC_WPARAM : TN_RC_OK;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_read(
+      struct TN_AsyncWait **pp_wait
+      )
+{
+   return (pp_wait == TN_NULL) ? TN_RC_WPARAM : TN_RC_OK;
+}
+
+#else
+#  define _check_param_generic(completion)                     (TN_RC_OK)
+#  define _check_param_create(completion)                      (TN_RC_OK)
+#  define _check_param_wait(wait)                              (TN_RC_OK)
+#  define _check_param_read(pp_wait)                           (TN_RC_OK)
+#endif
+// }}}
+
+/**
+ * Callback function that is given to `_tn_task_first_wait_complete()`
+ * when task finishes waiting for the completion object.
+ *
+ * See `#_TN_CBBeforeTaskWaitComplete` for details on function signature.
+ */
+static void _cb_before_task_wait_complete(
+      struct TN_Task   *task,
+      void             *user_data_1,
+      void             *user_data_2
+      )
+{
+   task->subsys_wait.async_compl.wait = (struct TN_AsyncWait *)user_data_1;
+   _TN_UNUSED(user_data_2);
+}
+
+/**
+ * Take the first completed wait from the `done_list` of the completion
+ * object, which should not be empty. After that, the node may be given
+ * to some asynchronous wait function again.
+ */
+static struct TN_AsyncWait *_done_list_take(struct TN_AsyncCompl *completion)
+{
+   struct TN_AsyncWait *wait = _tn_list_first_entry_remove(
+         &completion->done_list, struct TN_AsyncWait, queue_item
+         );
+
+   _tn_list_reset(&wait->queue_item);
+   wait->queued = TN_FALSE;
+
+   return wait;
+}
+
+/**
+ * Generic function that takes completed wait from the completion object,
+ * with the given timeout.
+ */
+static enum TN_RCode _compl_wait(
+      struct TN_AsyncCompl *completion,
+      struct TN_AsyncWait **pp_wait,
+      TN_TickCnt timeout
+      )
+{
+   TN_BOOL waited = TN_FALSE;
+   enum TN_RCode rc = _check_param_generic(completion);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if ((rc = _check_param_read(pp_wait)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (!_tn_list_is_empty(&completion->done_list)){
+         //-- there is a completed wait already: take it
+         *pp_wait = _done_list_take(completion);
+      } else {
+         rc = TN_RC_TIMEOUT;
+
+         if (timeout != 0){
+            _tn_task_curr_to_wait_action(
+                  &(completion->wait_queue),
+                  TN_WAIT_REASON_ASYNC_COMPL,
+                  timeout
+                  );
+            waited = TN_TRUE;
+         }
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+
+         if (rc == TN_RC_OK){
+            *pp_wait = _tn_curr_run_task->subsys_wait.async_compl.wait;
+         }
+      }
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_wait_init(
+      struct TN_AsyncWait *wait,
+      TN_AsyncCB *callback,
+      struct TN_AsyncCompl *completion,
+      void *user_data
+      )
+{
+   enum TN_RCode rc = _check_param_wait(wait);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&wait->queue_item);
+      wait->callback    = callback;
+      wait->completion  = completion;
+      wait->user_data   = user_data;
+      wait->p_data      = TN_NULL;
+      wait->rc          = TN_RC_OK;
+      wait->pending     = TN_FALSE;
+      wait->queued      = TN_FALSE;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_wait_cancel(struct TN_AsyncWait *wait)
+{
+   enum TN_RCode rc = _check_param_wait(wait);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (wait->pending){
+         _tn_list_remove_entry(&wait->queue_item);
+         wait->pending = TN_FALSE;
+      } else {
+         rc = TN_RC_WSTATE;
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_compl_create(struct TN_AsyncCompl *completion)
+{
+   enum TN_RCode rc = _check_param_create(completion);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&completion->wait_queue);
+      _tn_list_reset(&completion->done_list);
+
+      completion->id_compl = TN_ID_ASYNC_COMPL;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_compl_delete(struct TN_AsyncCompl *completion)
+{
+   enum TN_RCode rc = _check_param_generic(completion);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- notify waiting tasks that the object is deleted
+      //   (TN_RC_DELETED is returned)
+      _tn_wait_queue_notify_deleted(&(completion->wait_queue), TN_INTSAVE_VAR);
+
+      //-- forget completed waits which weren't taken, so that their nodes
+      //   can be used again
+      while (!_tn_list_is_empty(&completion->done_list)){
+         _done_list_take(completion);
+      }
+
+      completion->id_compl = TN_ID_NONE; //-- object does not exist now
+
+      TN_INT_RESTORE();
+
+      //-- we might need to switch context if _tn_wait_queue_notify_deleted()
+      //   has woken up some high-priority task
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_compl_wait(
+      struct TN_AsyncCompl *completion,
+      struct TN_AsyncWait **pp_wait,
+      TN_TickCnt timeout
+      )
+{
+   return _compl_wait(completion, pp_wait, timeout);
+}
+
+/*
+ * See comments in the header file (tn_async.h)
+ */
+enum TN_RCode tn_async_compl_wait_polling(
+      struct TN_AsyncCompl *completion,
+      struct TN_AsyncWait **pp_wait
+      )
+{
+   return _compl_wait(completion, pp_wait, 0);
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (_tn_async.h)
+ */
+void _tn_async_wait_add(
+      struct TN_ListItem *async_wait_queue,
+      struct TN_AsyncWait *wait
+      )
+{
+   wait->pending = TN_TRUE;
+   _tn_list_add_tail(async_wait_queue, &wait->queue_item);
+}
+
+/*
+ * See comments in the header file (_tn_async.h)
+ */
+void _tn_async_wait_complete(
+      struct TN_AsyncWait *wait,
+      enum TN_RCode rc,
+      void *p_data
+      )
+{
+   wait->rc       = rc;
+   wait->p_data   = p_data;
+   wait->pending  = TN_FALSE;
+
+   if (wait->callback != TN_NULL){
+      wait->callback(wait);
+   }
+
+   if (wait->completion != TN_NULL){
+      //-- if some task waits for the completion object, give the node to
+      //   it right away; otherwise, add the node to the list of completed
+      //   waits.
+      if (  !_tn_task_first_wait_complete(
+               &wait->completion->wait_queue, TN_RC_OK,
+               _cb_before_task_wait_complete, wait, TN_NULL
+               )
+         )
+      {
+         _tn_list_add_tail(&wait->completion->done_list, &wait->queue_item);
+         wait->queued = TN_TRUE;
+      }
+   }
+}
+
+/*
+ * See comments in the header file (_tn_async.h)
+ */
+TN_BOOL _tn_async_first_wait_complete(
+      struct TN_ListItem *async_wait_queue,
+      enum TN_RCode rc,
+      void *p_data
+      )
+{
+   TN_BOOL ret = TN_FALSE;
+
+   if (!_tn_list_is_empty(async_wait_queue)){
+      struct TN_AsyncWait *wait = _tn_list_first_entry_remove(
+            async_wait_queue, struct TN_AsyncWait, queue_item
+            );
+
+      _tn_async_wait_complete(wait, rc, p_data);
+      ret = TN_TRUE;
+   }
+
+   return ret;
+}
+
+/*
+ * See comments in the header file (_tn_async.h)
+ */
+void _tn_async_wait_queue_notify_deleted(
+      struct TN_ListItem *async_wait_queue
+      )
+{
+   while (_tn_async_first_wait_complete(
+            async_wait_queue, TN_RC_DELETED, TN_NULL
+            ))
+   {
+      //-- all the job is done in _tn_async_first_wait_complete()
+   }
+}
+
+
+#endif // TN_ASYNC_WAIT
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
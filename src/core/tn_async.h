@@ -0,0 +1,348 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Asynchronous waits: non-blocking counterparts of kernel waits.
+ *
+ * Usual kernel waits, such as `tn_sem_wait()`, put the calling task to
+ * sleep until the resource becomes available. So, if some task needs to
+ * serve a lot of resources, it either polls them, or there should be a
+ * separate task blocked on each resource.
+ *
+ * Asynchronous waits (`tn_sem_wait_async()`, `tn_queue_receive_async()`,
+ * `tn_fmem_get_async()`) never block: they just register the waiter node,
+ * `struct #TN_AsyncWait`, in the object, and return. When the resource
+ * becomes available, the kernel completes the wait: stores the result in
+ * the node, and then calls the completion callback and/or puts the node to
+ * the completion object, `struct #TN_AsyncCompl`. So, a single event-loop
+ * task can wait for all its resources at once:
+ *
+ * \code{.c}
+ * struct TN_AsyncCompl completion;
+ * struct TN_AsyncWait rx_wait, sem_wait;
+ *
+ * tn_async_compl_create(&completion);
+ * tn_async_wait_init(&rx_wait, TN_NULL, &completion, TN_NULL);
+ * tn_async_wait_init(&sem_wait, TN_NULL, &completion, TN_NULL);
+ *
+ * tn_queue_receive_async(&rx_queue, &rx_wait);
+ * tn_sem_wait_async(&sem, &sem_wait);
+ *
+ * for (;;){
+ *    struct TN_AsyncWait *wait;
+ *    tn_async_compl_wait(&completion, &wait, TN_WAIT_INFINITE);
+ *
+ *    if (wait == &rx_wait){
+ *       if (wait->rc == TN_RC_OK){
+ *          //-- handle message wait->p_data
+ *       }
+ *       tn_queue_receive_async(&rx_queue, &rx_wait);
+ *    } else if (wait == &sem_wait){
+ *       // ...
+ *    }
+ * }
+ * \endcode
+ *
+ * Waiter nodes are kept in the object in a separate list: tasks blocked on
+ * the object are served first, then the asynchronous waiters, each group in
+ * FIFO order.
+ *
+ * Available if only `#TN_ASYNC_WAIT` is non-zero.
+ */
+
+#ifndef _TN_ASYNC_H
+#define _TN_ASYNC_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+struct TN_AsyncWait;
+
+/**
+ * Completion callback of the asynchronous wait.
+ *
+ * It is called by the kernel right after the result is stored in the
+ * waiter node, in the context of whoever has completed the wait (task or
+ * ISR), **with interrupts disabled**. So, it should be very short, and it
+ * must not call any kernel services. Typical usage is to set some flag.
+ *
+ * @param wait
+ *    Completed waiter node; `rc` and `p_data` contain the result
+ */
+typedef void (TN_AsyncCB)(struct TN_AsyncWait *wait);
+
+/**
+ * Completion object: a list of completed asynchronous waits, that the
+ * event-loop task can wait for. See `tn_async_compl_wait()`.
+ */
+struct TN_AsyncCompl {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_compl;
+   ///
+   /// List of tasks that wait for completions
+   struct TN_ListItem wait_queue;
+   ///
+   /// List of completed waits which aren't taken yet
+   struct TN_ListItem done_list;
+};
+
+/**
+ * Waiter node of the asynchronous wait. It is allocated by the user, and
+ * should stay valid while the wait is pending, and until it is taken from
+ * the completion object (if any).
+ */
+struct TN_AsyncWait {
+   ///
+   /// List item to include the node in the object waiters list, or in the
+   /// `done_list` of the completion object.
+   struct TN_ListItem queue_item;
+   ///
+   /// Completion callback, can be `TN_NULL`.
+   TN_AsyncCB *callback;
+   ///
+   /// Completion object to put the node to, can be `TN_NULL`.
+   struct TN_AsyncCompl *completion;
+   ///
+   /// Arbitrary user data
+   void *user_data;
+   ///
+   /// Result data: data element received from the queue, or memory block
+   /// taken from the pool. Valid if only `rc` is `#TN_RC_OK`.
+   void *p_data;
+   ///
+   /// Result code: `#TN_RC_OK` if the resource is taken, or `#TN_RC_DELETED`
+   /// if the object was deleted.
+   enum TN_RCode rc;
+   ///
+   /// Whether the wait is registered in some object and isn't completed yet
+   volatile TN_BOOL pending;
+   ///
+   /// Whether the completed node is in the `done_list` of the completion
+   /// object, and isn't taken by `tn_async_compl_wait()` yet
+   volatile TN_BOOL queued;
+};
+
+/**
+ * Fields of the task which waits for the completion object, to be included
+ * in struct TN_Task.
+ */
+struct TN_AsyncComplTaskWait {
+   /// Completed wait which is given to the task
+   struct TN_AsyncWait *wait;
+};
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Initialize the waiter node. Should be called once, before the node is
+ * first given to any asynchronous wait function; after the wait is
+ * completed, the node may be used again without re-initialization. If
+ * `completion` isn't `TN_NULL`, the completed node may be used again only
+ * after it is taken by `tn_async_compl_wait()`: until then, asynchronous
+ * wait functions return `#TN_RC_WSTATE`.
+ *
+ * If both `callback` and `completion` are `TN_NULL`, the user should check
+ * the `pending` field of the node to find out whether the wait is completed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param wait
+ *    Pointer to already allocated `struct TN_AsyncWait`
+ * @param callback
+ *    Completion callback, see `#TN_AsyncCB`. Can be `TN_NULL`.
+ * @param completion
+ *    Completion object to put the completed node to. Can be `TN_NULL`.
+ * @param user_data
+ *    Arbitrary user data
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_async_wait_init(
+      struct TN_AsyncWait *wait,
+      TN_AsyncCB *callback,
+      struct TN_AsyncCompl *completion,
+      void *user_data
+      );
+
+/**
+ * Cancel the pending asynchronous wait: the node is removed from the
+ * object it waits for, and it isn't completed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param wait       waiter node
+ *
+ * @return
+ *    * `#TN_RC_OK` if the wait was cancelled;
+ *    * `#TN_RC_WSTATE` if the wait isn't pending (say, it is already
+ *      completed, and the caller should handle the result: for example,
+ *      release the memory block taken by the wait);
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_async_wait_cancel(struct TN_AsyncWait *wait);
+
+/**
+ * Construct the completion object. `id_compl` field should not contain
+ * `#TN_ID_ASYNC_COMPL`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param completion pointer to already allocated `struct TN_AsyncCompl`
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_async_compl_create(struct TN_AsyncCompl *completion);
+
+/**
+ * Destruct the completion object. All tasks that wait for it become
+ * runnable with `#TN_RC_DELETED` code returned. Completed waits which
+ * weren't taken are just forgotten.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param completion completion object to destruct
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_async_compl_delete(struct TN_AsyncCompl *completion);
+
+/**
+ * Take the first completed wait from the completion object. If there are
+ * no completed waits, behavior depends on `timeout` value: task might
+ * switch to $(TN_TASK_STATE_WAIT) state until some wait is completed or
+ * until the `timeout` expired. Refer to `#TN_TickCnt`.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param completion completion object
+ * @param pp_wait    pointer to where the completed waiter node should be
+ *                   stored
+ * @param timeout    refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if completed wait was taken;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_async_compl_wait(
+      struct TN_AsyncCompl *completion,
+      struct TN_AsyncWait **pp_wait,
+      TN_TickCnt timeout
+      );
+
+/**
+ * The same as `tn_async_compl_wait()` with zero timeout.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_async_compl_wait_polling(
+      struct TN_AsyncCompl *completion,
+      struct TN_AsyncWait **pp_wait
+      );
+
+#endif // TN_ASYNC_WAIT
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_ASYNC_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
@@ -115,6 +115,12 @@
 #  if !defined(TN_MUTEX_DEADLOCK_DETECT)
 #     error TN_MUTEX_DEADLOCK_DETECT is not defined
 #  endif
+#  if !defined(TN_MUTEX_DEADLOCK_DETECT_DEFER)
+#     error TN_MUTEX_DEADLOCK_DETECT_DEFER is not defined
+#  endif
+#  if !defined(TN_MUTEX_CEIL_LEARN)
+#     error TN_MUTEX_CEIL_LEARN is not defined
+#  endif
 #endif
 
 #if !defined(TN_TICK_LISTS_CNT)
@@ -133,6 +139,10 @@
 #  error TN_PROFILER_WAIT_TIME is not defined
 #endif
 
+#if !defined(TN_PROFILER_LIGHT)
+#  error TN_PROFILER_LIGHT is not defined
+#endif
+
 #if !defined(TN_INIT_INTERRUPT_STACK_SPACE)
 #  error TN_INIT_INTERRUPT_STACK_SPACE is not defined
 #endif
@@ -141,6 +151,19 @@
 #  error TN_STACK_OVERFLOW_CHECK is not defined
 #endif
 
+#if !defined(TN_STACK_FILL_LAZY)
+#  error TN_STACK_FILL_LAZY is not defined
+#endif
+
+#if TN_STACK_FILL_LAZY
+#  if !defined(TN_STACK_FILL_GUARD_SIZE)
+#     error TN_STACK_FILL_GUARD_SIZE is not defined
+#  endif
+#  if TN_STACK_FILL_GUARD_SIZE < 1
+#     error TN_STACK_FILL_GUARD_SIZE must be at least 1
+#  endif
+#endif
+
 #if defined (__TN_ARCH_PIC24_DSPIC__)
 #  if !defined(TN_P24_SYS_IPL)
 #     error TN_P24_SYS_IPL is not defined
@@ -151,6 +174,78 @@
 #  error TN_DYNAMIC_TICK is not defined
 #endif
 
+#if !defined(TN_PREEMPTIVE)
+#  error TN_PREEMPTIVE is not defined
+#endif
+
+#if !defined(TN_FAIR_SHARE)
+#  error TN_FAIR_SHARE is not defined
+#endif
+
+#if !defined(TN_TASK_GROUPS)
+#  error TN_TASK_GROUPS is not defined
+#endif
+
+#if !defined(TN_TIME_PARTITIONS)
+#  error TN_TIME_PARTITIONS is not defined
+#endif
+
+#if !defined(TN_TASK_RELEASE_TABLE)
+#  error TN_TASK_RELEASE_TABLE is not defined
+#endif
+
+#if !defined(TN_IDLE_GOVERNOR)
+#  error TN_IDLE_GOVERNOR is not defined
+#endif
+
+#if !defined(TN_HYBRID_TICK)
+#  error TN_HYBRID_TICK is not defined
+#endif
+
+#if !defined(TN_PREEMPT_POINT_ITEMS)
+#  error TN_PREEMPT_POINT_ITEMS is not defined
+#endif
+
+#if !defined(TN_LAZY_SCHED)
+#  error TN_LAZY_SCHED is not defined
+#endif
+
+#if !defined(TN_LAZY_TIMEOUT)
+#  error TN_LAZY_TIMEOUT is not defined
+#endif
+
+#if !defined(TN_ACTIVE_OBJECTS)
+#  error TN_ACTIVE_OBJECTS is not defined
+#endif
+
+#if !defined(TN_ASYNC_WAIT)
+#  error TN_ASYNC_WAIT is not defined
+#endif
+
+#if !defined(TN_RATE_LIMITER)
+#  error TN_RATE_LIMITER is not defined
+#endif
+
+#if !defined(TN_QUEUE_MATCH)
+#  error TN_QUEUE_MATCH is not defined
+#endif
+
+#if !defined(TN_ISR_RECORD)
+#  error TN_ISR_RECORD is not defined
+#endif
+
+#if !defined(TN_TIMER_STAT)
+#  error TN_TIMER_STAT is not defined
+#endif
+
+#if !defined(TN_FAST_API)
+#  error TN_FAST_API is not defined
+#endif
+
+#if !defined(TN_TICK_CNT_WIDTH)
+#  error TN_TICK_CNT_WIDTH is not defined
+#endif
+
 #if !defined(TN_OLD_EVENT_API)
 #  error TN_OLD_EVENT_API is not defined
 #endif
@@ -178,6 +273,49 @@
 #  endif
 #endif
 
+//-- check TN_TICK_CNT_WIDTH: should be 16, 32 or 64.
+#if (TN_TICK_CNT_WIDTH != 16) && (TN_TICK_CNT_WIDTH != 32) \
+   && (TN_TICK_CNT_WIDTH != 64)
+#  error TN_TICK_CNT_WIDTH must be 16, 32 or 64
+#endif
+
+//-- check TN_PROFILER_LIGHT: time deltas should fit in 32-bit accumulators
+#if TN_PROFILER && TN_PROFILER_LIGHT && (TN_TICK_CNT_WIDTH > 32)
+#  error TN_PROFILER_LIGHT requires TN_TICK_CNT_WIDTH of 16 or 32
+#endif
+
+//-- check TN_FAIR_SHARE: it is built on top of round-robin, which needs
+//   static tick and preemptive scheduling.
+#if TN_FAIR_SHARE
+#  if TN_DYNAMIC_TICK
+#     error TN_FAIR_SHARE is not available with TN_DYNAMIC_TICK
+#  endif
+#  if !TN_PREEMPTIVE
+#     error TN_FAIR_SHARE requires TN_PREEMPTIVE
+#  endif
+#endif
+
+//-- check TN_TIME_PARTITIONS: windows can't be enforced without preemption
+#if TN_TIME_PARTITIONS && !TN_PREEMPTIVE
+#  error TN_TIME_PARTITIONS requires TN_PREEMPTIVE
+#endif
+
+//-- check TN_IDLE_GOVERNOR: it needs to know the next deadline, which is
+//   known if only dynamic tick is used
+#if TN_IDLE_GOVERNOR && !TN_DYNAMIC_TICK
+#  error TN_IDLE_GOVERNOR requires TN_DYNAMIC_TICK
+#endif
+
+//-- check TN_HYBRID_TICK: it is built on top of static tick
+#if TN_HYBRID_TICK && TN_DYNAMIC_TICK
+#  error TN_HYBRID_TICK is not available with TN_DYNAMIC_TICK
+#endif
+
+//-- check TN_PREEMPT_POINT_ITEMS: zero (disabled) or positive
+#if TN_PREEMPT_POINT_ITEMS < 0
+#  error TN_PREEMPT_POINT_ITEMS must not be negative
+#endif
+
 //-- NOTE: TN_TICK_LISTS_CNT is checked in tn_timer_static.c
 //-- NOTE: TN_PRIORITIES_CNT is checked in tn_sys.c
 //-- NOTE: TN_API_MAKE_ALIG_ARG is checked in tn_common.h
@@ -73,6 +73,11 @@ enum TN_ObjId {
    TN_ID_TIMER          = (int)0x1A937FBC,  //!< id for timers
    TN_ID_EXCHANGE       = (int)0x32b7c072,  //!< id for exchange objects
    TN_ID_EXCHANGE_LINK  = (int)0x24d36f35,  //!< id for exchange link
+   TN_ID_TASK_GROUP     = (int)0x5B61D0A7,  //!< id for task groups
+   TN_ID_ACTIVE_OBJ     = (int)0x3D6E8A13,  //!< id for active objects
+   TN_ID_ASYNC_COMPL    = (int)0x6A41E52D,  //!< id for completion objects
+   TN_ID_RATE_LIMITER   = (int)0x4C19B7E3,  //!< id for rate limiters
+   TN_ID_ISR_REC        = (int)0x2E5D93B1,  //!< id for ISR call recorders
 };
 
 /**
@@ -184,8 +189,18 @@ typedef void (TN_TaskBody)(void *param);
  *   by means of `tn_task_release_wait()`. It this case, `#TN_RC_FORCED` is
  *   returned by the waiting function.  (the usage of the
  *   `tn_task_release_wait()` function is discouraged though)
+ *
+ * Width of this type is set by `#TN_TICK_CNT_WIDTH`.
  */
+#if (TN_TICK_CNT_WIDTH == 16)
+typedef unsigned short TN_TickCnt;
+#elif (TN_TICK_CNT_WIDTH == 32)
 typedef unsigned long TN_TickCnt;
+#elif (TN_TICK_CNT_WIDTH == 64)
+typedef unsigned long long TN_TickCnt;
+#else
+#  error wrong TN_TICK_CNT_WIDTH
+#endif
 
 /*******************************************************************************
  *    PROTECTED GLOBAL DATA
@@ -46,6 +46,8 @@
 #include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_async.h"
+#include "_tn_isrrec.h"
 
 
 #include "tn_dqueue.h"
@@ -206,6 +208,77 @@ static enum TN_RCode _fifo_read(struct TN_DQueue *dque, void **pp_data)
 
    return rc;
 }
+
+#if TN_QUEUE_MATCH
+/**
+ * Returns whether the tag of the data element matches given tag.
+ */
+static TN_BOOL _tag_match(
+      struct TN_DQueue *dque,
+      void *p_data,
+      TN_UWord tag,
+      TN_UWord mask
+      )
+{
+   TN_UWord elem_tag = (dque->tag_func != TN_NULL)
+      ? dque->tag_func(p_data)
+      : (TN_UWord)(TN_UIntPtr)p_data;
+
+   return (((elem_tag ^ tag) & mask) == 0);
+}
+
+/**
+ * Try to read the oldest data element which matches given tag from the FIFO.
+ * The data elements which follow the read one are moved one item back, so
+ * that the order of remaining data elements is kept.
+ *
+ * If matching data element is found, it is read, and `#TN_RC_OK` is
+ * returned; otherwise, `#TN_RC_TIMEOUT` is returned, and this case can 
+ * be handled by the caller.
+ */
+static enum TN_RCode _fifo_read_match(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask
+      )
+{
+   enum TN_RCode rc = TN_RC_TIMEOUT;
+   int idx = dque->tail_idx;
+   int i;
+
+   for (i = 0; i < dque->filled_items_cnt; i++){
+      if (_tag_match(dque, dque->data_fifo[idx], tag, mask)){
+         int next_idx;
+
+         *pp_data = dque->data_fifo[idx];
+
+         //-- close the gap: move the rest of data elements one item back
+         for (i++; i < dque->filled_items_cnt; i++){
+            next_idx = (idx + 1 < dque->items_cnt) ? (idx + 1) : 0;
+            dque->data_fifo[idx] = dque->data_fifo[next_idx];
+            idx = next_idx;
+         }
+
+         dque->head_idx = idx;
+         dque->filled_items_cnt--;
+
+         if (dque->filled_items_cnt == 0){
+            //-- clear flag in the connected event group (if any),
+            //   indicating that there are no messages in the queue
+            _tn_eventgrp_link_manage(&dque->eventgrp_link, TN_FALSE);
+         }
+
+         rc = TN_RC_OK;
+         break;
+      }
+
+      idx = (idx + 1 < dque->items_cnt) ? (idx + 1) : 0;
+   }
+
+   return rc;
+}
+#endif
 // }}}
 
 /**
@@ -225,6 +298,52 @@ static void _cb_before_task_wait_complete__send(
    _TN_UNUSED(user_data_2);
 }
 
+/**
+ * Give the data element to the first task that waits for it to be received,
+ * if any. If `#TN_QUEUE_MATCH` is non-zero, tasks waiting in
+ * `tn_queue_receive_match()` accept matching data elements only, so the first
+ * task which accepts the data element gets it.
+ *
+ * @return
+ *    `#TN_TRUE` if data element was given to some task, `#TN_FALSE` otherwise.
+ */
+static TN_BOOL _receiver_wait_complete(
+      struct TN_DQueue *dque,
+      void *p_data
+      )
+{
+#if TN_QUEUE_MATCH
+   TN_BOOL ret = TN_FALSE;
+   struct TN_Task *task;
+
+   _tn_list_for_each_entry(
+         task, struct TN_Task, &dque->wait_receive_list, task_queue
+         )
+   {
+      struct TN_DQueueTaskWait *dqueue_wait = &task->subsys_wait.dqueue;
+
+      if (     !dqueue_wait->match
+            || _tag_match(
+               dque, p_data, dqueue_wait->match_tag, dqueue_wait->match_mask
+               )
+         )
+      {
+         _cb_before_task_wait_complete__send(task, p_data, TN_NULL);
+         _tn_task_wait_complete(task, TN_RC_OK);
+         ret = TN_TRUE;
+         break;
+      }
+   }
+
+   return ret;
+#else
+   return _tn_task_first_wait_complete(
+         &dque->wait_receive_list, TN_RC_OK,
+         _cb_before_task_wait_complete__send, p_data, TN_NULL
+         );
+#endif
+}
+
 /**
  * Callback function that is given to `_tn_task_first_wait_complete()`
  * when task finishes waiting for free item in the queue.
@@ -238,9 +357,19 @@ static void _cb_before_task_wait_complete__receive_ok(
       )
 {
    struct TN_DQueue *dque = (struct TN_DQueue *)user_data_1;
+   enum TN_RCode rc = TN_RC_OK;
+
+#if TN_QUEUE_MATCH
+   //-- the queue was full, but some task might wait in
+   //   `tn_queue_receive_match()` for exactly this data element:
+   //   if so, give it to that task; otherwise, put to data FIFO.
+   if (!_receiver_wait_complete(dque, task->subsys_wait.dqueue.data_elem))
+#endif
+   {
+      //-- put to data FIFO
+      rc = _fifo_write(dque, task->subsys_wait.dqueue.data_elem); 
+   }
 
-   //-- put to data FIFO
-   enum TN_RCode rc = _fifo_write(dque, task->subsys_wait.dqueue.data_elem); 
    if (rc != TN_RC_OK){
       _TN_FATAL_ERROR("rc should always be TN_RC_OK here");
    }
@@ -304,18 +433,24 @@ static enum TN_RCode _queue_send(
    //   waits for receive message from the queue.
    //
    //   If yes, we just pass new message to the first task
-   //   from the waiting tasks list, and don't modify messages
+   //   from the waiting tasks list (which accepts the message, if
+   //   `TN_QUEUE_MATCH` is non-zero), and don't modify messages
    //   fifo at all.
    //
-   //   Otherwise (no waiting tasks), we add new message to the fifo.
+   //   Otherwise (no waiting tasks), we pass the message to the first
+   //   asynchronous waiter, if any.
+   //
+   //   Otherwise (nobody waits), we add new message to the fifo.
 
-   if (  !_tn_task_first_wait_complete(
-            &dque->wait_receive_list, TN_RC_OK,
-            _cb_before_task_wait_complete__send, p_data, TN_NULL
-            )
+   if (  !_receiver_wait_complete(dque, p_data)
+#if TN_ASYNC_WAIT
+         && !_tn_async_first_wait_complete(
+               &dque->async_receive_list, TN_RC_OK, p_data
+               )
+#endif
       )
    {
-      //-- the data queue's wait_receive list is empty
+      //-- the data queue's wait_receive lists are empty
       rc = _fifo_write(dque, p_data);
    }
 
@@ -398,12 +533,64 @@ static enum TN_RCode _queue_receive(
    return rc;
 }
 
+#if TN_QUEUE_MATCH
+/**
+ * Actual worker function that receives matching data from the queue, called
+ * by `tn_queue_receive_match()` and `tn_queue_receive_match_polling()`.
+ *
+ * It works like `_queue_receive()`, but the FIFO is scanned for the oldest
+ * matching data element (by `_fifo_read_match()`); if there's no such
+ * element, tasks that wait to send are scanned for the matching data element
+ * as well. Otherwise, `#TN_RC_TIMEOUT` is returned.
+ */
+static enum TN_RCode _queue_receive_match(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask
+      )
+{
+   enum TN_RCode rc = _fifo_read_match(dque, pp_data, tag, mask);
+
+   if (rc == TN_RC_OK){
+      //-- successfully read item from the queue.
+      //   if there are tasks that wait to send data to the queue,
+      //   wake the first one up, since there is room now.
+      _tn_task_first_wait_complete(
+            &dque->wait_send_list, TN_RC_OK,
+            _cb_before_task_wait_complete__receive_ok, dque, TN_NULL
+            );
+   } else {
+      //-- no matching item in the queue. Let's check whether some task
+      //   wants to send matching data (that might happen if the queue
+      //   is full, or if dque->items_cnt is 0)
+      struct TN_Task *task;
+
+      _tn_list_for_each_entry(
+            task, struct TN_Task, &dque->wait_send_list, task_queue
+            )
+      {
+         void *p_data = task->subsys_wait.dqueue.data_elem;
+
+         if (_tag_match(dque, p_data, tag, mask)){
+            *pp_data = p_data;
+            _tn_task_wait_complete(task, TN_RC_OK);
+            rc = TN_RC_OK;
+            break;
+         }
+      }
+   }
+
+   return rc;
+}
+#endif
+
 
 /**
  * Intermediary function that is called by queue-related services
  * (`tn_queue_send()`, `tn_queue_receive()`, etc), which performs all necessary
  * housekeeping and eventually calls actual worker function depending on given
- * `job_type`.
+ * `job_type`. Parameters and context should be already checked by the caller.
  *
  *
  * $(TN_CALL_FROM_TASK)
@@ -423,7 +610,7 @@ static enum TN_RCode _queue_receive(
  * @param timeout
  *    Refer to `#TN_TickCnt`.
  */
-static enum TN_RCode _dqueue_job_perform(
+static enum TN_RCode _dqueue_job_do(
       struct TN_DQueue *dque,
       enum _JobType job_type,
       void *p_data,
@@ -432,90 +619,109 @@ static enum TN_RCode _dqueue_job_perform(
 {
    TN_BOOL waited = TN_FALSE;
    void **pp_data = (void **)p_data;
-   enum TN_RCode rc = _check_param_generic(dque);
+   enum TN_RCode rc = TN_RC_OK;
+   TN_INTSAVE_DATA;
+
+   TN_INT_DIS_SAVE();
+
+   switch (job_type){
+
+      case _JOB_TYPE__SEND:
+         //-- try to put new item to the queue
+         rc = _queue_send(dque, p_data);
+
+         if (rc == TN_RC_TIMEOUT && timeout != 0){
+            //-- We can't put new item to the queue right now (queue is
+            //   full), and user asked to wait if that happens.
+            //
+            //   Save user-provided data in the `dqueue.data_elem` task
+            //   field, and put current task to wait until there's room in
+            //   the queue.
+            _tn_curr_run_task->subsys_wait.dqueue.data_elem = p_data;
+            _tn_task_curr_to_wait_action(
+                  &(dque->wait_send_list),
+                  TN_WAIT_REASON_DQUE_WSEND,
+                  timeout
+                  );
+
+            waited = TN_TRUE;
+         }
+         break;
 
-   if (rc != TN_RC_OK){
-      //-- just return rc as it is
-   } else if (!tn_is_task_context()){
-      rc = TN_RC_WCONTEXT;
-   } else {
-      TN_INTSAVE_DATA;
+      case _JOB_TYPE__RECEIVE:
+         //-- try to get the item from the queue
+         rc = _queue_receive(dque, pp_data);
+
+         if (rc == TN_RC_TIMEOUT && timeout != 0){
+            //-- Queue is empty right now, and user asked to wait if that
+            //   happens.
+            //
+            //   Put current task to wait until new data comes.
+#if TN_QUEUE_MATCH
+            _tn_curr_run_task->subsys_wait.dqueue.match = TN_FALSE;
+#endif
+            _tn_task_curr_to_wait_action(
+                  &(dque->wait_receive_list),
+                  TN_WAIT_REASON_DQUE_WRECEIVE,
+                  timeout
+                  );
 
-      TN_INT_DIS_SAVE();
+            waited = TN_TRUE;
+         }
+         break;
+   }
 
-      switch (job_type){
+#if TN_DEBUG
+   if (!_tn_need_context_switch() && waited){
+      _TN_FATAL_ERROR("");
+   }
+#endif
 
-         case _JOB_TYPE__SEND:
-            //-- try to put new item to the queue
-            rc = _queue_send(dque, p_data);
+   TN_INT_RESTORE();
+   _tn_context_switch_pend_if_needed();
+   if (waited){
 
-            if (rc == TN_RC_TIMEOUT && timeout != 0){
-               //-- We can't put new item to the queue right now (queue is
-               //   full), and user asked to wait if that happens.
-               //
-               //   Save user-provided data in the `dqueue.data_elem` task
-               //   field, and put current task to wait until there's room in
-               //   the queue.
-               _tn_curr_run_task->subsys_wait.dqueue.data_elem = p_data;
-               _tn_task_curr_to_wait_action(
-                     &(dque->wait_send_list),
-                     TN_WAIT_REASON_DQUE_WSEND,
-                     timeout
-                     );
-
-               waited = TN_TRUE;
-            }
-            break;
+      //-- get wait result
+      rc = _tn_curr_run_task->task_wait_rc;
 
+      switch (job_type){
+         case _JOB_TYPE__SEND:
+            //-- do nothing special
+            break;
          case _JOB_TYPE__RECEIVE:
-            //-- try to get the item from the queue
-            rc = _queue_receive(dque, pp_data);
-
-            if (rc == TN_RC_TIMEOUT && timeout != 0){
-               //-- Queue is empty right now, and user asked to wait if that
-               //   happens.
-               //
-               //   Put current task to wait until new data comes.
-               _tn_task_curr_to_wait_action(
-                     &(dque->wait_receive_list),
-                     TN_WAIT_REASON_DQUE_WRECEIVE,
-                     timeout
-                     );
-
-               waited = TN_TRUE;
+            //-- if wait result is TN_RC_OK, copy received pointer to the
+            //   user's location
+            if (rc == TN_RC_OK){
+               //-- dqueue.data_elem should contain valid value now,
+               //   return it to caller
+               *pp_data = _tn_curr_run_task->subsys_wait.dqueue.data_elem;
             }
             break;
       }
+   }
 
-#if TN_DEBUG
-      if (!_tn_need_context_switch() && waited){
-         _TN_FATAL_ERROR("");
-      }
-#endif
-
-      TN_INT_RESTORE();
-      _tn_context_switch_pend_if_needed();
-      if (waited){
-
-         //-- get wait result
-         rc = _tn_curr_run_task->task_wait_rc;
+   return rc;
+}
 
-         switch (job_type){
-            case _JOB_TYPE__SEND:
-               //-- do nothing special
-               break;
-            case _JOB_TYPE__RECEIVE:
-               //-- if wait result is TN_RC_OK, copy received pointer to the
-               //   user's location
-               if (rc == TN_RC_OK){
-                  //-- dqueue.data_elem should contain valid value now,
-                  //   return it to caller
-                  *pp_data = _tn_curr_run_task->subsys_wait.dqueue.data_elem;
-               }
-               break;
-         }
-      }
+/**
+ * Checks parameters and context, and calls `_dqueue_job_do()`.
+ * See comments for `_dqueue_job_do()` for parameters description.
+ */
+_TN_STATIC_INLINE enum TN_RCode _dqueue_job_perform(
+      struct TN_DQueue *dque,
+      enum _JobType job_type,
+      void *p_data,
+      TN_TickCnt timeout
+      )
+{
+   enum TN_RCode rc = _check_param_generic(dque);
 
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      rc = _dqueue_job_do(dque, job_type, p_data, timeout);
    }
    return rc;
 }
@@ -597,6 +803,12 @@ enum TN_RCode tn_queue_create(
    } else {
       _tn_list_reset(&(dque->wait_send_list));
       _tn_list_reset(&(dque->wait_receive_list));
+#if TN_ASYNC_WAIT
+      _tn_list_reset(&(dque->async_receive_list));
+#endif
+#if TN_QUEUE_MATCH
+      dque->tag_func          = TN_NULL;
+#endif
 
       dque->data_fifo         = data_fifo;
       dque->items_cnt         = items_cnt;
@@ -637,8 +849,11 @@ enum TN_RCode tn_queue_delete(struct TN_DQueue * dque)
 
       //-- notify waiting tasks that the object is deleted
       //   (TN_RC_DELETED is returned)
-      _tn_wait_queue_notify_deleted(&(dque->wait_send_list));
-      _tn_wait_queue_notify_deleted(&(dque->wait_receive_list));
+      _tn_wait_queue_notify_deleted(&(dque->wait_send_list), TN_INTSAVE_VAR);
+      _tn_wait_queue_notify_deleted(&(dque->wait_receive_list), TN_INTSAVE_VAR);
+#if TN_ASYNC_WAIT
+      _tn_async_wait_queue_notify_deleted(&(dque->async_receive_list));
+#endif
 
       dque->id_dque = TN_ID_NONE; //-- data queue does not exist now
 
@@ -682,7 +897,12 @@ enum TN_RCode tn_queue_send_polling(struct TN_DQueue *dque, void *p_data)
  */
 enum TN_RCode tn_queue_isend_polling(struct TN_DQueue *dque, void *p_data)
 {
-   return _dqueue_job_iperform(dque, _JOB_TYPE__SEND, p_data);
+   enum TN_RCode rc = _dqueue_job_iperform(dque, _JOB_TYPE__SEND, p_data);
+
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_QUEUE_ISEND_POLLING, dque, (TN_UIntPtr)p_data, 0, rc
+         );
+   return rc;
 }
 
 
@@ -713,8 +933,189 @@ enum TN_RCode tn_queue_receive_polling(struct TN_DQueue *dque, void **pp_data)
  */
 enum TN_RCode tn_queue_ireceive_polling(struct TN_DQueue *dque, void **pp_data)
 {
-   return _dqueue_job_iperform(dque, _JOB_TYPE__RECEIVE, pp_data);
+   enum TN_RCode rc = _dqueue_job_iperform(dque, _JOB_TYPE__RECEIVE, pp_data);
+
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_QUEUE_IRECEIVE_POLLING, dque,
+         (rc == TN_RC_OK) ? (TN_UIntPtr)*pp_data : 0, 0, rc
+         );
+   return rc;
+}
+
+#if TN_FAST_API
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_send_fast(
+      struct TN_DQueue *dque,
+      void *p_data,
+      TN_TickCnt timeout
+      )
+{
+   _TN_BUG_ON(!_tn_dqueue_is_valid(dque) || !tn_is_task_context());
+
+   return _dqueue_job_do(dque, _JOB_TYPE__SEND, p_data, timeout);
+}
+
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_receive_fast(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_TickCnt timeout
+      )
+{
+   _TN_BUG_ON(!_tn_dqueue_is_valid(dque) || !tn_is_task_context());
+
+   return _dqueue_job_do(dque, _JOB_TYPE__RECEIVE, pp_data, timeout);
 }
+#endif
+
+#if TN_QUEUE_MATCH
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_receive_match(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask,
+      TN_TickCnt timeout
+      )
+{
+   TN_BOOL waited = TN_FALSE;
+   enum TN_RCode rc = _check_param_generic(dque);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (_check_param_read(pp_data) != TN_RC_OK){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      rc = _queue_receive_match(dque, pp_data, tag, mask);
+
+      if (rc == TN_RC_TIMEOUT && timeout != 0){
+         //-- There's no matching data in the queue right now, and user
+         //   asked to wait if that happens.
+         //
+         //   Save the tag to match, and put current task to wait until
+         //   matching data comes.
+         struct TN_DQueueTaskWait *dqueue_wait
+            = &_tn_curr_run_task->subsys_wait.dqueue;
+
+         dqueue_wait->match      = TN_TRUE;
+         dqueue_wait->match_tag  = tag;
+         dqueue_wait->match_mask = mask;
+
+         _tn_task_curr_to_wait_action(
+               &(dque->wait_receive_list),
+               TN_WAIT_REASON_DQUE_WRECEIVE,
+               timeout
+               );
+
+         waited = TN_TRUE;
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+
+         if (rc == TN_RC_OK){
+            //-- dqueue.data_elem should contain valid value now,
+            //   return it to caller
+            *pp_data = _tn_curr_run_task->subsys_wait.dqueue.data_elem;
+         }
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_receive_match_polling(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask
+      )
+{
+   return tn_queue_receive_match(dque, pp_data, tag, mask, 0);
+}
+
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_tag_func_set(
+      struct TN_DQueue *dque,
+      TN_DQueueTagFunc *tag_func
+      )
+{
+   enum TN_RCode rc = _check_param_generic(dque);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+      dque->tag_func = tag_func;
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+#endif
+
+#if TN_ASYNC_WAIT
+/*
+ * See comments in the header file (tn_dqueue.h)
+ */
+enum TN_RCode tn_queue_receive_async(
+      struct TN_DQueue *dque,
+      struct TN_AsyncWait *wait
+      )
+{
+   enum TN_RCode rc = _check_param_generic(dque);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (wait == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      void *p_data;
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (_tn_async_wait_is_busy(wait)){
+         rc = TN_RC_WSTATE;
+      } else if (_queue_receive(dque, &p_data) == TN_RC_OK){
+         //-- data is received right away
+         _tn_async_wait_complete(wait, TN_RC_OK, p_data);
+      } else {
+         //-- the queue is empty: register the wait
+         _tn_async_wait_add(&(dque->async_receive_list), wait);
+      }
+
+      TN_INT_RESTORE();
+
+      //-- receiving might have woken up the task that waits to send, and
+      //   completion might have woken up the task that waits for the
+      //   completion object
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+#endif
 
 /*
  * See comments in the header file (tn_dqueue.h)
@@ -70,6 +70,12 @@
  * connection technique: `examples/queue_eventgrp_conn`. Be sure to examine the
  * readme there.
  *
+ * If `#TN_QUEUE_MATCH` is non-zero, a task can also receive not the oldest
+ * data element, but the oldest one whose tag matches the given value, see
+ * `tn_queue_receive_match()`. By default, the tag is the data element itself
+ * (handy when the elements are integers), or it can be extracted from the
+ * message by the function given to `tn_queue_tag_func_set()`.
+ *
  */
 
 #ifndef _TN_DQUEUE_H
@@ -82,6 +88,7 @@
 #include "tn_list.h"
 #include "tn_common.h"
 #include "tn_eventgrp.h"
+#include "tn_async.h"
 
 
 
@@ -99,6 +106,23 @@ extern "C"  {  /*}*/
  *    PUBLIC TYPES
  ******************************************************************************/
 
+#if TN_QUEUE_MATCH || DOXYGEN_ACTIVE
+/**
+ * Prototype for the function that returns the tag of the data element,
+ * see `tn_queue_tag_func_set()`.
+ *
+ * It is called with interrupts disabled, so it should be very short: it
+ * typically just reads some field of the message pointed to by `p_data`.
+ *
+ * @param p_data
+ *    Data element, as it was given to `tn_queue_send()`.
+ *
+ * @return
+ *    Tag of the data element, which is compared by `tn_queue_receive_match()`.
+ */
+typedef TN_UWord (TN_DQueueTagFunc)(void *p_data);
+#endif
+
 /**
  * Structure representing data queue object
  */
@@ -133,6 +157,19 @@ struct TN_DQueue {
    ///
    /// connected event group
    struct TN_EGrpLink eventgrp_link;
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+   ///
+   /// list of asynchronous waiters for data, see `tn_queue_receive_async()`.
+   /// Available if only `#TN_ASYNC_WAIT` is non-zero.
+   struct TN_ListItem  async_receive_list;
+#endif
+#if TN_QUEUE_MATCH || DOXYGEN_ACTIVE
+   ///
+   /// function that returns the tag of the data element, or `TN_NULL` if
+   /// the data element itself is the tag. See `tn_queue_tag_func_set()`.
+   /// Available if only `#TN_QUEUE_MATCH` is non-zero.
+   TN_DQueueTagFunc   *tag_func;
+#endif
 };
 
 /**
@@ -144,6 +181,19 @@ struct TN_DQueueTaskWait {
    /// and there's no space in the queue, value to put to queue is stored
    /// in this field
    void *data_elem;
+#if TN_QUEUE_MATCH || DOXYGEN_ACTIVE
+   ///
+   /// if task waits in `tn_queue_receive_match()`, it is `#TN_TRUE`, and
+   /// `match_tag` and `match_mask` specify data elements it accepts.
+   /// Available if only `#TN_QUEUE_MATCH` is non-zero.
+   TN_BOOL  match;
+   ///
+   /// tag to match, see `tn_queue_receive_match()`
+   TN_UWord match_tag;
+   ///
+   /// mask of tag bits to compare, see `tn_queue_receive_match()`
+   TN_UWord match_mask;
+#endif
 };
 
 
@@ -330,6 +380,175 @@ enum TN_RCode tn_queue_ireceive_polling(
       void **pp_data
       );
 
+#if TN_FAST_API || DOXYGEN_ACTIVE
+/**
+ * The same as `tn_queue_send()`, but without checking of parameters and
+ * context, no matter `#TN_CHECK_PARAM`: intended for the measured hot
+ * paths. The queue should be valid, and the function should be called from
+ * task only; with `#TN_DEBUG`, violation leads to `_TN_FATAL_ERROR()`,
+ * otherwise the behavior is undefined.
+ *
+ * Available if only `#TN_FAST_API` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    * `#TN_RC_OK`   if data was successfully sent;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ */
+enum TN_RCode tn_queue_send_fast(
+      struct TN_DQueue *dque,
+      void *p_data,
+      TN_TickCnt timeout
+      );
+
+/**
+ * The same as `tn_queue_receive()`, but without checking of parameters and
+ * context, see `tn_queue_send_fast()`.
+ *
+ * Available if only `#TN_FAST_API` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    * `#TN_RC_OK`   if data was successfully received;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ */
+enum TN_RCode tn_queue_receive_fast(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_TickCnt timeout
+      );
+#endif
+
+#if TN_QUEUE_MATCH || DOXYGEN_ACTIVE
+/**
+ * Selective receive: receive the oldest data element whose tag matches the
+ * given one, that is, `(elem_tag & mask) == (tag & mask)`. The tag of the
+ * element is returned by the function given to `tn_queue_tag_func_set()`, or,
+ * if there's no such function, it is the data element itself.
+ *
+ * Non-matching data elements are left in the queue, in their original order.
+ * If there is no matching data element in the queue, the task waits until
+ * the matching one is sent: senders hand matching data elements directly to
+ * the waiting task, without putting them to the FIFO. The waiting time
+ * depends on the `timeout` value: refer to `#TN_TickCnt`.
+ *
+ * Note that the matching scans the FIFO, so the time spent with interrupts
+ * disabled is proportional to the number of items in the queue.
+ *
+ * Available if only `#TN_QUEUE_MATCH` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param dque       pointer to data queue to receive data from
+ * @param pp_data    pointer to location to store the value
+ * @param tag        tag to match
+ * @param mask       mask of tag bits to compare; if it is 0, any data element
+ *                   matches, as in `tn_queue_receive()`
+ * @param timeout    refer to `#TN_TickCnt`
+ *
+ * @return  
+ *    * `#TN_RC_OK`   if data was successfully received;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_queue_receive_match(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask,
+      TN_TickCnt timeout
+      );
+
+/**
+ * The same as `tn_queue_receive_match()` with zero timeout
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_queue_receive_match_polling(
+      struct TN_DQueue *dque,
+      void **pp_data,
+      TN_UWord tag,
+      TN_UWord mask
+      );
+
+/**
+ * Set the function that returns the tag of the data element, used by
+ * `tn_queue_receive_match()`. Typically, messages are structures with the
+ * tag field (say, sequence number), and the function just returns it.
+ *
+ * By default (or if `TN_NULL` is given), the data element itself is the tag.
+ *
+ * Available if only `#TN_QUEUE_MATCH` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param dque       pointer to data queue
+ * @param tag_func   function that returns the tag, or `TN_NULL`
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_queue_tag_func_set(
+      struct TN_DQueue *dque,
+      TN_DQueueTagFunc *tag_func
+      );
+#endif
+
+
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+/**
+ * Asynchronous version of `tn_queue_receive()`: it never blocks.
+ *
+ * If there is some data in the queue, it is received, and the wait is
+ * completed right away (`p_data` field of the waiter node contains the
+ * data). Otherwise, the wait is registered in the queue, and it is
+ * completed when some data is sent to the queue (when there are no tasks
+ * blocked in `tn_queue_receive()`). Refer to tn_async.h for details.
+ *
+ * Available if only `#TN_ASYNC_WAIT` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param dque    pointer to data queue
+ * @param wait    waiter node, see `tn_async_wait_init()`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the wait is registered (or completed right away);
+ *    * `#TN_RC_WSTATE` if the wait is already pending, or it is completed
+ *      but isn't taken from the completion object yet;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_queue_receive_async(
+      struct TN_DQueue *dque,
+      struct TN_AsyncWait *wait
+      );
+#endif
 
 /**
  * Returns number of free items in the queue
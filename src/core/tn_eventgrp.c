@@ -45,6 +45,7 @@
 #include "_tn_eventgrp.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_isrrec.h"
 
 
 //-- header of current module
@@ -240,7 +241,12 @@ static void _scan_event_waitqueue(struct TN_EventGrp *eventgrp)
    struct TN_Task *tmp_task;
 
    //-- Walk through all tasks waiting for some event, checking
-   //   if each particular condition is satisfied
+   //   if each particular condition is satisfied.
+   //
+   //   NOTE: there are no preemption points here (see
+   //   `#TN_PREEMPT_POINT_ITEMS`): all the waiters should be checked against
+   //   the same pattern, otherwise some ISR could clear flags in the middle
+   //   of the scan, and the rest of the waiters would miss the wakeup.
    _tn_list_for_each_entry_safe(
          task, struct TN_Task, tmp_task, &(eventgrp->wait_queue), task_queue
          )
@@ -444,7 +450,7 @@ enum TN_RCode tn_eventgrp_delete(struct TN_EventGrp *eventgrp)
 
       // remove all waiting tasks from wait list (if any), returning the
       // TN_RC_DELETED code.
-      _tn_wait_queue_notify_deleted(&(eventgrp->wait_queue));
+      _tn_wait_queue_notify_deleted(&(eventgrp->wait_queue), TN_INTSAVE_VAR);
 
       eventgrp->id_event = TN_ID_NONE; //-- event does not exist now
 
@@ -591,6 +597,11 @@ enum TN_RCode tn_eventgrp_iwait_polling(
       _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
 
    }
+
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_EVENTGRP_IWAIT_POLLING, eventgrp,
+         wait_pattern, wait_mode, rc
+         );
    return rc;
 }
 
@@ -652,6 +663,10 @@ enum TN_RCode tn_eventgrp_imodify(
       TN_INT_IRESTORE();
       _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
    }
+
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_EVENTGRP_IMODIFY, eventgrp, pattern, operation, rc
+         );
    return rc;
 }
 
@@ -46,6 +46,8 @@
 //-- internal tnkernel headers
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_async.h"
+#include "_tn_isrrec.h"
 
 
 //-- header of current module
@@ -227,13 +229,20 @@ _TN_STATIC_INLINE enum TN_RCode _fmem_release(struct TN_FMem *fmem, void *p_data
 
    //-- Check if there are tasks waiting for memory block. If there is,
    //   give the block to the first task from the queue.
+   //   If there are no tasks, give the block to the first asynchronous
+   //   waiter, if any.
    if (  !_tn_task_first_wait_complete(
             &fmem->wait_queue, TN_RC_OK,
             _cb_before_task_wait_complete, p_data, TN_NULL
             )
+#if TN_ASYNC_WAIT
+         && !_tn_async_first_wait_complete(
+               &fmem->async_wait_queue, TN_RC_OK, p_data
+               )
+#endif
       )
    {
-      //-- no task is waiting for free memory block, so,
+      //-- nobody is waiting for free memory block, so,
       //   insert in to the memory pool
 
       if (fmem->free_blocks_cnt < fmem->blocks_cnt){
@@ -319,6 +328,9 @@ enum TN_RCode tn_fmem_create(
 
    //-- reset wait_queue
    _tn_list_reset(&(fmem->wait_queue));
+#if TN_ASYNC_WAIT
+   _tn_list_reset(&(fmem->async_wait_queue));
+#endif
 
    //-- init block pointers
    {
@@ -364,7 +376,10 @@ enum TN_RCode tn_fmem_delete(struct TN_FMem *fmem)
       TN_INT_DIS_SAVE();
 
       //-- remove all tasks (if any) from fmem's wait queue
-      _tn_wait_queue_notify_deleted(&(fmem->wait_queue));
+      _tn_wait_queue_notify_deleted(&(fmem->wait_queue), TN_INTSAVE_VAR);
+#if TN_ASYNC_WAIT
+      _tn_async_wait_queue_notify_deleted(&(fmem->async_wait_queue));
+#endif
 
       fmem->id_fmp = TN_ID_NONE;   //-- Fixed-size memory pool does not exist now
 
@@ -475,6 +490,11 @@ enum TN_RCode tn_fmem_iget_polling(struct TN_FMem *fmem, void **p_data)
       TN_INT_IRESTORE();
       _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
    }
+
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_FMEM_IGET_POLLING, fmem,
+         (rc == TN_RC_OK) ? (TN_UIntPtr)*p_data : 0, 0, rc
+         );
    return rc;
 }
 
@@ -526,9 +546,56 @@ enum TN_RCode tn_fmem_irelease(struct TN_FMem *fmem, void *p_data)
       _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
    }
 
+   _TN_ISRREC_PUT(
+         TN_ISRREC_CALL_FMEM_IRELEASE, fmem, (TN_UIntPtr)p_data, 0, rc
+         );
    return rc;
 }
 
+#if TN_ASYNC_WAIT
+/*
+ * See comments in the header file (tn_fmem.h)
+ */
+enum TN_RCode tn_fmem_get_async(
+      struct TN_FMem *fmem,
+      struct TN_AsyncWait *wait
+      )
+{
+   enum TN_RCode rc = _check_param_generic(fmem);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (wait == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      void *p_data;
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (_tn_async_wait_is_busy(wait)){
+         rc = TN_RC_WSTATE;
+      } else if (_fmem_get(fmem, &p_data) == TN_RC_OK){
+         //-- memory block is allocated right away
+         _tn_async_wait_complete(wait, TN_RC_OK, p_data);
+      } else {
+         //-- there are no free blocks: register the wait
+         _tn_async_wait_add(&(fmem->async_wait_queue), wait);
+      }
+
+      TN_INT_RESTORE();
+
+      //-- completion might have woken up the task that waits for the
+      //   completion object
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+#endif
+
 /*
  * See comments in the header file (tn_dqueue.h)
  */
@@ -63,6 +63,7 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_async.h"
 
 
 
@@ -108,6 +109,12 @@ struct TN_FMem {
    /// pointer to the next free memory block as the first word, or `NULL` if
    /// this is the last block.
    void                *free_list;
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+   ///
+   /// list of asynchronous waiters for free memory block, see
+   /// `tn_fmem_get_async()`. Available if only `#TN_ASYNC_WAIT` is non-zero.
+   struct TN_ListItem   async_wait_queue;
+#endif
 };
 
 
@@ -329,6 +336,39 @@ enum TN_RCode tn_fmem_release(struct TN_FMem *fmem, void *p_data);
  */
 enum TN_RCode tn_fmem_irelease(struct TN_FMem *fmem, void *p_data);
 
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+/**
+ * Asynchronous version of `tn_fmem_get()`: it never blocks.
+ *
+ * If there is a free memory block, it is allocated, and the wait is
+ * completed right away (`p_data` field of the waiter node contains the
+ * block address). Otherwise, the wait is registered in the memory pool, and
+ * it is completed when some block is released (when there are no tasks
+ * blocked in `tn_fmem_get()`). Refer to tn_async.h for details.
+ *
+ * Available if only `#TN_ASYNC_WAIT` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param fmem    pointer to memory pool
+ * @param wait    waiter node, see `tn_async_wait_init()`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the wait is registered (or completed right away);
+ *    * `#TN_RC_WSTATE` if the wait is already pending, or it is completed
+ *      but isn't taken from the completion object yet;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_fmem_get_async(
+      struct TN_FMem *fmem,
+      struct TN_AsyncWait *wait
+      );
+#endif
+
 /**
  * Returns number of free blocks in the memory pool
  *
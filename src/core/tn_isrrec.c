@@ -0,0 +1,417 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_sys.h"
+#include "_tn_timer.h"
+
+
+//-- header of current module
+#include "_tn_isrrec.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+#include "tn_sem.h"
+#include "tn_dqueue.h"
+#include "tn_eventgrp.h"
+#include "tn_fmem.h"
+
+
+#if TN_ISR_RECORD
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/// Running recorder, or `TN_NULL`
+static struct TN_IsrRec *_running_rec = TN_NULL;
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_IsrRec *rec
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rec == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_isrrec_is_valid(rec)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating recorder
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_IsrRec *rec,
+      struct TN_IsrRecEntry *entries,
+      int entries_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rec == TN_NULL || entries == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (entries_cnt <= 0 || _tn_isrrec_is_valid(rec)){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+#else
+#  define _check_param_generic(rec)                               (TN_RC_OK)
+#  define _check_param_create(rec, entries, entries_cnt)          (TN_RC_OK)
+#endif
+// }}}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_create(
+      struct TN_IsrRec       *rec,
+      struct TN_IsrRecEntry  *entries,
+      int                     entries_cnt,
+      TN_IsrRecTimeFunc      *time_func
+      )
+{
+   enum TN_RCode rc = _check_param_create(rec, entries, entries_cnt);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      rec->entries      = entries;
+      rec->entries_cnt  = entries_cnt;
+      rec->head_idx     = 0;
+      rec->total_cnt    = 0;
+      rec->time_func    = time_func;
+
+      rec->id_isrrec = TN_ID_ISR_REC;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_delete(struct TN_IsrRec *rec)
+{
+   enum TN_RCode rc = _check_param_generic(rec);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (_running_rec == rec){
+         _running_rec = TN_NULL;
+      }
+
+      rec->id_isrrec = TN_ID_NONE; //-- recorder does not exist now
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_start(struct TN_IsrRec *rec)
+{
+   enum TN_RCode rc = _check_param_generic(rec);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      rec->head_idx  = 0;
+      rec->total_cnt = 0;
+      _running_rec   = rec;
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_stop(struct TN_IsrRec *rec)
+{
+   enum TN_RCode rc = _check_param_generic(rec);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (_running_rec == rec){
+         _running_rec = TN_NULL;
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+int tn_isrrec_entries_cnt_get(struct TN_IsrRec *rec)
+{
+   int ret = -1;
+   enum TN_RCode rc = _check_param_generic(rec);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      ret = (rec->total_cnt < (TN_UWord)rec->entries_cnt)
+         ? (int)rec->total_cnt
+         : rec->entries_cnt;
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return ret;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_entry_get(
+      struct TN_IsrRec       *rec,
+      int                     num,
+      struct TN_IsrRecEntry  *p_entry
+      )
+{
+   enum TN_RCode rc = _check_param_generic(rec);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (p_entry == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (num < 0 || (TN_UWord)num >= rec->total_cnt
+            || num >= rec->entries_cnt)
+      {
+         rc = TN_RC_WPARAM;
+      } else {
+         //-- if the ring buffer has wrapped, the oldest entry is the one
+         //   at the head index
+         int idx = num;
+
+         if (rec->total_cnt > (TN_UWord)rec->entries_cnt){
+            idx += rec->head_idx;
+            if (idx >= rec->entries_cnt){
+               idx -= rec->entries_cnt;
+            }
+         }
+
+         *p_entry = rec->entries[idx];
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_isrrec.h)
+ */
+enum TN_RCode tn_isrrec_replay(const struct TN_IsrRecEntry *entry)
+{
+   enum TN_RCode rc = TN_RC_OK;
+   void *p_data;
+   TN_UWord flags_pattern;
+
+   switch ((enum TN_IsrRecCall)entry->call){
+      case TN_ISRREC_CALL_TICK:
+         tn_tick_int_processing();
+         break;
+
+      case TN_ISRREC_CALL_SEM_ISIGNAL:
+         rc = tn_sem_isignal((struct TN_Sem *)entry->obj);
+         break;
+
+      case TN_ISRREC_CALL_SEM_IWAIT_POLLING:
+         rc = tn_sem_iwait_polling((struct TN_Sem *)entry->obj);
+         break;
+
+      case TN_ISRREC_CALL_QUEUE_ISEND_POLLING:
+         rc = tn_queue_isend_polling(
+               (struct TN_DQueue *)entry->obj, (void *)entry->arg
+               );
+         break;
+
+      case TN_ISRREC_CALL_QUEUE_IRECEIVE_POLLING:
+         rc = tn_queue_ireceive_polling(
+               (struct TN_DQueue *)entry->obj, &p_data
+               );
+         break;
+
+      case TN_ISRREC_CALL_EVENTGRP_IMODIFY:
+         rc = tn_eventgrp_imodify(
+               (struct TN_EventGrp *)entry->obj,
+               (enum TN_EGrpOp)entry->arg2,
+               entry->arg
+               );
+         break;
+
+      case TN_ISRREC_CALL_EVENTGRP_IWAIT_POLLING:
+         rc = tn_eventgrp_iwait_polling(
+               (struct TN_EventGrp *)entry->obj,
+               entry->arg,
+               (enum TN_EGrpWaitMode)entry->arg2,
+               &flags_pattern
+               );
+         break;
+
+      case TN_ISRREC_CALL_FMEM_IGET_POLLING:
+         rc = tn_fmem_iget_polling((struct TN_FMem *)entry->obj, &p_data);
+         break;
+
+      case TN_ISRREC_CALL_FMEM_IRELEASE:
+         rc = tn_fmem_irelease(
+               (struct TN_FMem *)entry->obj, (void *)entry->arg
+               );
+         break;
+
+      case TN_ISRREC_CALL_TASK_IWAKEUP:
+         rc = tn_task_iwakeup((struct TN_Task *)entry->obj);
+         break;
+
+      case TN_ISRREC_CALL_TASK_IACTIVATE:
+         rc = tn_task_iactivate((struct TN_Task *)entry->obj);
+         break;
+
+      case TN_ISRREC_CALL_TASK_IRELEASE_WAIT:
+         rc = tn_task_irelease_wait((struct TN_Task *)entry->obj);
+         break;
+
+      default:
+         rc = TN_RC_WPARAM;
+         break;
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the file _tn_isrrec.h
+ */
+void _tn_isrrec_put(
+      enum TN_IsrRecCall call,
+      void *obj,
+      TN_UWord arg,
+      int arg2,
+      enum TN_RCode rc
+      )
+{
+   //-- the service might be called with interrupts enabled or disabled
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   struct TN_IsrRec *rec = _running_rec;
+
+   if (rec != TN_NULL){
+      struct TN_IsrRecEntry *entry = &rec->entries[rec->head_idx];
+
+      entry->time = (rec->time_func != TN_NULL)
+         ? rec->time_func()
+         : (TN_UWord)_tn_timer_sys_time_get();
+      entry->obj  = obj;
+      entry->arg  = arg;
+      entry->call = (unsigned char)call;
+      entry->arg2 = (unsigned char)arg2;
+      entry->rc   = (signed char)rc;
+
+      rec->head_idx++;
+      if (rec->head_idx >= rec->entries_cnt){
+         rec->head_idx = 0;
+      }
+      rec->total_cnt++;
+   }
+
+   tn_arch_sr_restore(sr_saved);
+}
+
+#endif // TN_ISR_RECORD
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
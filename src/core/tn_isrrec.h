@@ -0,0 +1,369 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Recorder of interrupt-originated kernel calls, for reproducing latency
+ * incidents.
+ *
+ * While the recorder is running, each call of the ISR kernel services
+ * (`tn_sem_isignal()`, `tn_queue_isend_polling()`, `tn_eventgrp_imodify()`
+ * and others, see `enum #TN_IsrRecCall`) as well as each system tick
+ * (`tn_tick_int_processing()`) is stored in the user-provided array of
+ * entries: timestamp, call, object, argument and the returned code. The array
+ * is used as a ring buffer, so it always holds the latest entries. Typically,
+ * the recorder is stopped by `tn_isrrec_stop()` when the incident is
+ * detected (say, a deadline is missed), and entries are read by
+ * `tn_isrrec_entry_get()` and sent to the host.
+ *
+ * The timestamp is taken from the user-provided function, which usually
+ * reads some free-running hardware counter; if there's no such function,
+ * the system tick count is used.
+ *
+ * On the host, the script `stuff/scripts/tn_isrrec.py` shows the timeline,
+ * compares two recordings (the first divergence is reported), and generates
+ * C source of the replay harness: the table of recorded entries with object
+ * addresses resolved to symbols, and the driver which re-issues them one by
+ * one by `tn_isrrec_replay()` in the virtual time, that is, the timestamp
+ * function returns the timestamp of the entry being replayed. So, the
+ * same stimulus can be applied to the kernel built for the simulator (or for
+ * the target, with the replay interrupt instead of real ones) by different
+ * versions of the application, and if the recorder is running during
+ * replay, recordings can be compared.
+ *
+ * Entries are stored after the call has returned, so if some interrupt
+ * preempts another one right at the end of the kernel call, their entries
+ * might be stored in the order of recording, not in the order of calls.
+ *
+ * Available if only `#TN_ISR_RECORD` is non-zero.
+ */
+
+#ifndef _TN_ISRREC_H
+#define _TN_ISRREC_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_common.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+#if TN_ISR_RECORD || DOXYGEN_ACTIVE
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Recorded kernel call, stored in `call` field of `struct #TN_IsrRecEntry`.
+ *
+ * \attention Values are part of the recording format understood by
+ * `stuff/scripts/tn_isrrec.py`, so new values should only be added to the
+ * end.
+ */
+enum TN_IsrRecCall {
+   ///
+   /// `tn_tick_int_processing()`
+   TN_ISRREC_CALL_TICK,
+   ///
+   /// `tn_sem_isignal()`
+   TN_ISRREC_CALL_SEM_ISIGNAL,
+   ///
+   /// `tn_sem_iwait_polling()`
+   TN_ISRREC_CALL_SEM_IWAIT_POLLING,
+   ///
+   /// `tn_queue_isend_polling()`, `arg` is the data element
+   TN_ISRREC_CALL_QUEUE_ISEND_POLLING,
+   ///
+   /// `tn_queue_ireceive_polling()`, `arg` is the received data element
+   TN_ISRREC_CALL_QUEUE_IRECEIVE_POLLING,
+   ///
+   /// `tn_eventgrp_imodify()`, `arg` is the pattern, `arg2` is the
+   /// operation
+   TN_ISRREC_CALL_EVENTGRP_IMODIFY,
+   ///
+   /// `tn_eventgrp_iwait_polling()`, `arg` is the wait pattern, `arg2` is
+   /// the wait mode
+   TN_ISRREC_CALL_EVENTGRP_IWAIT_POLLING,
+   ///
+   /// `tn_fmem_iget_polling()`, `arg` is the obtained memory block
+   TN_ISRREC_CALL_FMEM_IGET_POLLING,
+   ///
+   /// `tn_fmem_irelease()`, `arg` is the memory block
+   TN_ISRREC_CALL_FMEM_IRELEASE,
+   ///
+   /// `tn_task_iwakeup()`
+   TN_ISRREC_CALL_TASK_IWAKEUP,
+   ///
+   /// `tn_task_iactivate()`
+   TN_ISRREC_CALL_TASK_IACTIVATE,
+   ///
+   /// `tn_task_irelease_wait()`
+   TN_ISRREC_CALL_TASK_IRELEASE_WAIT,
+};
+
+/**
+ * One recorded call.
+ */
+struct TN_IsrRecEntry {
+   ///
+   /// Timestamp, see `#TN_IsrRecTimeFunc`
+   TN_UWord       time;
+   ///
+   /// Object given to the service (`TN_NULL` for the system tick)
+   void          *obj;
+   ///
+   /// Argument, depends on `call`, see `enum #TN_IsrRecCall`
+   TN_UWord       arg;
+   ///
+   /// Recorded call, see `enum #TN_IsrRecCall`
+   unsigned char  call;
+   ///
+   /// Additional argument, depends on `call`, see `enum #TN_IsrRecCall`
+   unsigned char  arg2;
+   ///
+   /// Code returned by the service, see `enum #TN_RCode`
+   signed char    rc;
+};
+
+/**
+ * Prototype for the function that returns the timestamp of the entry. It is
+ * called from the kernel services with interrupts disabled, so it should
+ * just read some free-running counter.
+ */
+typedef TN_UWord (TN_IsrRecTimeFunc)(void);
+
+/**
+ * Recorder
+ */
+struct TN_IsrRec {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_isrrec;
+   ///
+   /// Array of entries, used as a ring buffer
+   struct TN_IsrRecEntry *entries;
+   ///
+   /// Number of items in the `entries` array
+   int entries_cnt;
+   ///
+   /// Index of the item to be written next time
+   int head_idx;
+   ///
+   /// Total number of calls recorded since the recorder was started
+   /// (including the ones overwritten by the later calls)
+   TN_UWord total_cnt;
+   ///
+   /// Function that returns timestamp, or `TN_NULL` if the system tick
+   /// count is used
+   TN_IsrRecTimeFunc *time_func;
+};
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Construct the recorder. The recorder isn't running until
+ * `tn_isrrec_start()` is called.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder to construct
+ * @param entries       array of entries
+ * @param entries_cnt   number of items in the `entries` array
+ * @param time_func     function that returns timestamp, or `TN_NULL` if
+ *                      the system tick count should be used
+ *
+ * @return
+ *    * `#TN_RC_OK` if recorder was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_isrrec_create(
+      struct TN_IsrRec       *rec,
+      struct TN_IsrRecEntry  *entries,
+      int                     entries_cnt,
+      TN_IsrRecTimeFunc      *time_func
+      );
+
+/**
+ * Destruct the recorder. If it is running, it is stopped.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder to destruct
+ *
+ * @return
+ *    * `#TN_RC_OK` if recorder was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_isrrec_delete(struct TN_IsrRec *rec);
+
+/**
+ * Discard recorded entries and start recording. Only one recorder can be
+ * running at a time: if another one is running, it is stopped.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder to start
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_isrrec_start(struct TN_IsrRec *rec);
+
+/**
+ * Stop recording; recorded entries are kept. It is usually called when the
+ * incident is detected.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder to stop
+ *
+ * @return
+ *    * `#TN_RC_OK` on success (including the case when the recorder
+ *      isn't running);
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_isrrec_stop(struct TN_IsrRec *rec);
+
+/**
+ * Returns number of entries stored in the recorder: it is the number of
+ * calls recorded since start, but not more than the size of the array.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder
+ *
+ * @return
+ *    Number of entries, or -1 if wrong params were given (the check is
+ *    performed if only `#TN_CHECK_PARAM` is non-zero)
+ */
+int tn_isrrec_entries_cnt_get(struct TN_IsrRec *rec);
+
+/**
+ * Copy stored entry to the user-provided location. Entries are numbered
+ * from the oldest one (0) to the latest one (`tn_isrrec_entries_cnt_get()`
+ * minus one). The recorder should be stopped, otherwise numbering shifts
+ * as new calls are recorded.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rec           recorder
+ * @param num           number of entry, from the oldest one
+ * @param p_entry       location to store the entry to
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WPARAM` if `num` is out of range;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_isrrec_entry_get(
+      struct TN_IsrRec       *rec,
+      int                     num,
+      struct TN_IsrRecEntry  *p_entry
+      );
+
+/**
+ * Re-issue the recorded call: the same service is called with the same
+ * object and arguments. Used by the replay harness generated by
+ * `stuff/scripts/tn_isrrec.py`; the caller typically compares returned value
+ * with the recorded one, `rc` field of the entry.
+ *
+ * For `#TN_ISRREC_CALL_QUEUE_IRECEIVE_POLLING` and
+ * `#TN_ISRREC_CALL_FMEM_IGET_POLLING`, the received data is discarded.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param entry         entry to replay
+ *
+ * @return
+ *    Value returned by the service, or `#TN_RC_WPARAM` if the entry has
+ *    unknown `call` value.
+ */
+enum TN_RCode tn_isrrec_replay(const struct TN_IsrRecEntry *entry);
+
+#endif // TN_ISR_RECORD
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_ISRREC_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
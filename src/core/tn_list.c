@@ -141,6 +141,29 @@ _TN_MAX_INLINED_FUNC void _tn_list_remove_entry(struct TN_ListItem *entry)
    //         to get the next item.
 }
 
+/*
+ * See comments in the header file tn_list.h
+ */
+_TN_MAX_INLINED_FUNC void _tn_list_move_all(
+      struct TN_ListItem *dst,
+      struct TN_ListItem *src
+      )
+{
+   if (src->next == src){
+      //-- source list is empty, so is the destination one
+      dst->prev = dst->next = dst;
+   } else {
+      //-- make items of the source list reference the destination head
+      dst->next = src->next;
+      dst->prev = src->prev;
+      dst->next->prev = dst;
+      dst->prev->next = dst;
+
+      //-- and make the source list empty
+      src->prev = src->next = src;
+   }
+}
+
 /*
  * See comments in the header file tn_list.h
  */
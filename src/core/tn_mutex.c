@@ -71,6 +71,24 @@
       container_of(que, struct TN_Mutex, wait_queue)
 #endif
 
+//-- whether deadlock detection is deferred to the idle task
+#define _DEADLOCK_DETECT_DEFER                           \
+   (TN_MUTEX_DEADLOCK_DETECT && TN_MUTEX_DEADLOCK_DETECT_DEFER)
+
+
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#if _DEADLOCK_DETECT_DEFER
+/// List of tasks which started waiting for some mutex, but aren't checked
+/// for deadlock yet (see `#TN_MUTEX_DEADLOCK_DETECT_DEFER`)
+static struct TN_ListItem _deadlock_check_list = {
+   &_deadlock_check_list, &_deadlock_check_list
+};
+#endif
+
 
 
 
@@ -404,6 +422,12 @@ static void _check_deadlock_active(struct TN_Mutex *mutex, struct TN_Task *task)
 {
    struct TN_Task *holder;
 
+   //-- chain of holders without deadlock can't be longer than the number
+   //   of tasks, so, the walk is bounded by it: otherwise, we would loop
+   //   forever if the chain leads to some other deadlock which doesn't
+   //   involve the task (such a deadlock is already detected)
+   int steps_left = _tn_tasks_created_cnt;
+
 in:
    holder = mutex->holder;
    if (     (_tn_task_is_waiting(task))
@@ -443,8 +467,10 @@ in:
          //
          //_check_deadlock_active(mutex2, task);
 
-         mutex = mutex2;
-         goto in;
+         if (--steps_left > 0){
+            mutex = mutex2;
+            goto in;
+         }
       }
 
    } else {
@@ -515,8 +541,16 @@ _TN_STATIC_INLINE void _add_curr_task_to_mutex_wait_queue(
 
    _tn_task_curr_to_wait_action(&(mutex->wait_queue), wait_reason, timeout);
 
+#if _DEADLOCK_DETECT_DEFER
+   //-- deadlock will be checked later by the idle task,
+   //   see _tn_mutex_deadlock_check_deferred()
+   _tn_list_add_tail(
+         &_deadlock_check_list, &(_tn_curr_run_task->deadlock_check_queue)
+         );
+#else
    //-- check if there is deadlock
    _check_deadlock_active(mutex, _tn_curr_run_task);
+#endif
 }
 
 /**
@@ -657,6 +691,23 @@ in:
    }
 }
 
+#if TN_MUTEX_CEIL_LEARN
+/**
+ * Remember base priority of the task which tries to lock the mutex, if it
+ * is the highest one so far (see `#TN_MUTEX_CEIL_LEARN`).
+ * Interrupts should be disabled when calling it.
+ */
+_TN_STATIC_INLINE void _ceil_learn(
+      struct TN_Mutex *mutex,
+      struct TN_Task *task
+      )
+{
+   if (task->base_priority < mutex->learned_priority){
+      mutex->learned_priority = task->base_priority;
+   }
+}
+#endif
+
 
 
 /*******************************************************************************
@@ -688,6 +739,10 @@ enum TN_RCode tn_mutex_create(
       mutex->holder        = TN_NULL;
       mutex->ceil_priority = ceil_priority;
       mutex->cnt           = 0;
+#if TN_MUTEX_CEIL_LEARN
+      mutex->learned_priority    = TN_PRIORITIES_CNT;
+      mutex->ceil_violations_cnt = 0;
+#endif
       mutex->id_mutex      = TN_ID_MUTEX;
    }
 
@@ -716,7 +771,7 @@ enum TN_RCode tn_mutex_delete(struct TN_Mutex *mutex)
       } else {
 
          //-- Remove all tasks (if any) from mutex's wait queue
-         _tn_wait_queue_notify_deleted(&(mutex->wait_queue));
+         _tn_wait_queue_notify_deleted(&(mutex->wait_queue), TN_INTSAVE_VAR);
 
          if (mutex->holder != TN_NULL){
             //-- If the mutex is locked
@@ -760,6 +815,10 @@ enum TN_RCode tn_mutex_lock(struct TN_Mutex *mutex, TN_TickCnt timeout)
 
       TN_INT_DIS_SAVE();
 
+#if TN_MUTEX_CEIL_LEARN
+      _ceil_learn(mutex, _tn_curr_run_task);
+#endif
+
       if (_tn_curr_run_task == mutex->holder){
          //-- mutex is already locked by current task
          //   if recursive locking enabled (TN_MUTEX_REC), increment lock count,
@@ -775,6 +834,11 @@ enum TN_RCode tn_mutex_lock(struct TN_Mutex *mutex, TN_TickCnt timeout)
          //-- base priority of current task higher
          rc = TN_RC_ILLEGAL_USE;
 
+#if TN_MUTEX_CEIL_LEARN
+         mutex->ceil_violations_cnt++;
+         _tn_cry_mutex_ceil_violation(mutex, _tn_curr_run_task);
+#endif
+
       } else if (mutex->holder == TN_NULL){
          //-- mutex is not locked, let's lock it
 
@@ -877,6 +941,69 @@ enum TN_RCode tn_mutex_unlock(struct TN_Mutex *mutex)
 
 }
 
+#if TN_MUTEX_CEIL_LEARN
+/*
+ * See comments in the header file (tn_mutex.h)
+ */
+enum TN_RCode tn_mutex_ceil_learned_get(
+      struct TN_Mutex *mutex,
+      int *p_ceil_priority
+      )
+{
+   enum TN_RCode rc = _check_param_generic(mutex);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      if (mutex->learned_priority >= TN_PRIORITIES_CNT){
+         //-- no task has tried to lock the mutex yet
+         rc = TN_RC_WSTATE;
+      } else {
+         *p_ceil_priority = mutex->learned_priority;
+      }
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_mutex.h)
+ */
+enum TN_RCode tn_mutex_ceil_apply(struct TN_Mutex *mutex)
+{
+   enum TN_RCode rc = _check_param_generic(mutex);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (     mutex->holder != TN_NULL
+            || mutex->learned_priority >= TN_PRIORITIES_CNT
+         )
+      {
+         //-- the protocol can't be changed while some task holds the mutex
+         //   (and, therefore, maybe some tasks wait for it); and if nothing
+         //   is learned, there's nothing to apply.
+         rc = TN_RC_WSTATE;
+      } else {
+         mutex->protocol      = TN_MUTEX_PROT_CEILING;
+         mutex->ceil_priority = mutex->learned_priority;
+      }
+
+      TN_INT_RESTORE();
+   }
+
+   return rc;
+}
+#endif
+
 
 
 
@@ -888,21 +1015,30 @@ enum TN_RCode tn_mutex_unlock(struct TN_Mutex *mutex)
 /**
  * See comment in _tn_mutex.h file
  */
-void _tn_mutex_unlock_all_by_task(struct TN_Task *task)
+void _tn_mutex_unlock_all_by_task(
+      struct TN_Task *task,
+      TN_UWord TN_INTSAVE_VAR
+      )
 {
-   struct TN_Mutex *mutex;       //-- "cursor" for the loop iteration
-   struct TN_Mutex *tmp_mutex;   //-- we need for temporary item because
-                                 //   item is removed from the list
-                                 //   in _mutex_do_unlock().
+   int items_cnt = 0;
+
+   //-- NOTE: we don't iterate with `_tn_list_for_each_entry_safe()` here,
+   //   because interrupts might be enabled in _tn_sys_preempt_point(),
+   //   and timeouts of tasks waiting for these mutexes may modify
+   //   the state of the mutex. So, we just take the head every time.
+   while (!_tn_list_is_empty(&(task->mutex_queue))){
+      struct TN_Mutex *mutex = _tn_list_first_entry(
+            &(task->mutex_queue), struct TN_Mutex, mutex_queue
+            );
 
-   _tn_list_for_each_entry_safe(
-         mutex, struct TN_Mutex, tmp_mutex, &(task->mutex_queue), mutex_queue
-         )
-   {
       //-- NOTE: we don't remove item from the list, because it is removed
       //   inside _mutex_do_unlock().
       _mutex_do_unlock(mutex);
+
+      _tn_sys_preempt_point(&items_cnt, TN_INTSAVE_VAR);
    }
+
+   _tn_sys_preempt_points_done();
 }
 
 
@@ -939,6 +1075,12 @@ void _tn_mutex_i_on_task_wait_complete(struct TN_Task *task)
  */
 void _tn_mutex_on_task_wait_complete(struct TN_Task *task)
 {
+#if _DEADLOCK_DETECT_DEFER
+   //-- if the task isn't checked for deadlock yet, it needn't be anymore
+   _tn_list_remove_entry(&(task->deadlock_check_queue));
+   _tn_list_reset(&(task->deadlock_check_queue));
+#endif
+
    //-- if deadlock was active with given task involved,
    //   it means that deadlock becomes inactive. So, notify user about it
    //   and unlink deadlock lists (for mutexes and tasks involved)
@@ -948,6 +1090,46 @@ void _tn_mutex_on_task_wait_complete(struct TN_Task *task)
          );
 }
 
+#if _DEADLOCK_DETECT_DEFER
+/**
+ * See comments in _tn_mutex.h file
+ */
+void _tn_mutex_deadlock_check_deferred(void)
+{
+   TN_BOOL done = TN_FALSE;
+
+   while (!done){
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (_tn_list_is_empty(&_deadlock_check_list)){
+         done = TN_TRUE;
+      } else {
+         //-- the task is still waiting for the mutex: otherwise it would be
+         //   removed from the list in _tn_mutex_on_task_wait_complete()
+         struct TN_Task *task = _tn_list_first_entry(
+               &_deadlock_check_list, struct TN_Task, deadlock_check_queue
+               );
+
+         _tn_list_remove_entry(&(task->deadlock_check_queue));
+         _tn_list_reset(&(task->deadlock_check_queue));
+
+         //-- if the task is involved in the deadlock which is already
+         //   detected (when checking some other task), don't link it again
+         if (_tn_list_is_empty(&(task->deadlock_list))){
+            _check_deadlock_active(
+                  _get_mutex_by_wait_queque(task->pwait_queue),
+                  task
+                  );
+         }
+      }
+
+      TN_INT_RESTORE();
+   }
+}
+#endif
+
 
 #endif //-- TN_USE_MUTEXES
 
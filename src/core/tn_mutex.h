@@ -150,6 +150,18 @@ struct TN_Mutex {
    ///
    /// Lock count (for recursive locking)
    int cnt;
+#if TN_MUTEX_CEIL_LEARN || DOXYGEN_ACTIVE
+   ///
+   /// Highest base priority of the tasks that ever tried to lock the mutex,
+   /// or `#TN_PRIORITIES_CNT` if there were no such tasks yet.
+   /// Available if only `#TN_MUTEX_CEIL_LEARN` is non-zero.
+   int learned_priority;
+   ///
+   /// Number of attempts to lock the mutex with `#TN_MUTEX_PROT_CEILING`
+   /// protocol by tasks with priority higher than `ceil_priority`.
+   /// Available if only `#TN_MUTEX_CEIL_LEARN` is non-zero.
+   unsigned int ceil_violations_cnt;
+#endif
 };
 
 /*******************************************************************************
@@ -285,6 +297,60 @@ enum TN_RCode tn_mutex_lock_polling(struct TN_Mutex *mutex);
  */
 enum TN_RCode tn_mutex_unlock(struct TN_Mutex *mutex);
 
+#if TN_MUTEX_CEIL_LEARN || DOXYGEN_ACTIVE
+/**
+ * Get the minimal correct priority ceiling for the mutex, learned so far:
+ * that is, the highest base priority of all the tasks that ever tried to
+ * lock the mutex. Available if only `#TN_MUTEX_CEIL_LEARN` is non-zero.
+ *
+ * Note that the result is only as good as the test coverage: if some task
+ * didn't lock the mutex during the learning run, it isn't taken into account.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param mutex
+ *    mutex to get learned ceiling of
+ * @param p_ceil_priority
+ *    Pointer to the variable to store the learned ceiling to
+ *
+ * @return
+ *    * `#TN_RC_OK` if the ceiling is stored to `*p_ceil_priority`;
+ *    * `#TN_RC_WSTATE` if no task has tried to lock the mutex yet;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_mutex_ceil_learned_get(
+      struct TN_Mutex *mutex,
+      int *p_ceil_priority
+      );
+
+/**
+ * Apply learned priority ceiling (see `tn_mutex_ceil_learned_get()`):
+ * set `ceil_priority` of the mutex to it, and switch the mutex to the
+ * `#TN_MUTEX_PROT_CEILING` protocol (if the mutex used
+ * `#TN_MUTEX_PROT_INHERIT`). The mutex should not be locked.
+ *
+ * Available if only `#TN_MUTEX_CEIL_LEARN` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param mutex
+ *    mutex to apply learned ceiling to
+ *
+ * @return
+ *    * `#TN_RC_OK` if the ceiling is applied;
+ *    * `#TN_RC_WSTATE` if the mutex is locked, or if no task has tried to
+ *      lock the mutex yet;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_mutex_ceil_apply(struct TN_Mutex *mutex);
+#endif
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
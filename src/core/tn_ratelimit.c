@@ -0,0 +1,493 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+//-- common tnkernel headers
+#include "tn_common.h"
+#include "tn_sys.h"
+
+//-- internal tnkernel headers
+#include "_tn_tasks.h"
+#include "_tn_timer.h"
+#include "_tn_list.h"
+
+
+//-- header of current module
+#include "_tn_ratelimit.h"
+
+//-- header of other needed modules
+#include "tn_tasks.h"
+
+
+#if TN_RATE_LIMITER
+
+
+
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+//-- Additional param checking {{{
+#if TN_CHECK_PARAM
+_TN_STATIC_INLINE enum TN_RCode _check_param_generic(
+      const struct TN_RateLimiter *rl
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rl == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!_tn_ratelimit_is_valid(rl)){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking when creating rate limiter
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_create(
+      const struct TN_RateLimiter *rl,
+      int capacity,
+      TN_TickCnt period,
+      int start_tokens_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (rl == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (0
+         || _tn_ratelimit_is_valid(rl)
+         || capacity <= 0
+         || period == 0
+         //-- time to fill the whole bucket should fit in the half of the
+         //   tick counter range, see _timer_restart()
+         || period > (TN_WAIT_INFINITE >> 1) / (unsigned long)capacity
+         || start_tokens_cnt < 0
+         || start_tokens_cnt > capacity
+         )
+   {
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+
+/**
+ * Additional param checking of the number of tokens to take
+ */
+_TN_STATIC_INLINE enum TN_RCode _check_param_take(
+      const struct TN_RateLimiter *rl,
+      int tokens_cnt
+      )
+{
+   return (tokens_cnt <= 0 || tokens_cnt > rl->capacity)
+      ? TN_RC_WPARAM
+      : TN_RC_OK;
+}
+
+#else
+#  define _check_param_generic(rl)                                (TN_RC_OK)
+#  define _check_param_create(rl, capacity, period, start_tokens_cnt)        \
+                                                                  (TN_RC_OK)
+#  define _check_param_take(rl, tokens_cnt)                       (TN_RC_OK)
+#endif
+// }}}
+
+
+/**
+ * Add tokens accrued since the last refill. Nothing accrues while the bucket
+ * is full.
+ *
+ * Should be called with interrupts disabled.
+ */
+static void _refill(struct TN_RateLimiter *rl)
+{
+   TN_TickCnt cur_time = _tn_timer_sys_time_get();
+   TN_TickCnt elapsed = (TN_TickCnt)(cur_time - rl->last_refill_time);
+
+   if (rl->tokens_cnt >= rl->capacity){
+      //-- the bucket is full: tokens start to accrue from now
+      rl->last_refill_time = cur_time;
+   } else if (elapsed >= rl->period){
+      TN_TickCnt accrued = elapsed / rl->period;
+
+      if (accrued >= (TN_TickCnt)(rl->capacity - rl->tokens_cnt)){
+         rl->tokens_cnt = rl->capacity;
+         rl->last_refill_time = cur_time;
+      } else {
+         //-- keep the fraction of the period which has elapsed towards
+         //   the next token
+         rl->tokens_cnt += (int)accrued;
+         rl->last_refill_time += accrued * rl->period;
+      }
+   }
+}
+
+/**
+ * Start the timer so that it fires when the first waiter's tokens have
+ * accrued, or cancel it if nobody waits.
+ *
+ * Should be called with interrupts disabled, just after `_refill()`.
+ */
+static void _timer_restart(struct TN_RateLimiter *rl)
+{
+   if (_tn_list_is_empty(&rl->wait_queue)){
+      _tn_timer_cancel(&rl->timer);
+   } else {
+      struct TN_Task *task = _tn_list_first_entry(
+            &rl->wait_queue, struct TN_Task, task_queue
+            );
+      int lack = task->subsys_wait.ratelimit.tokens_cnt - rl->tokens_cnt;
+
+      if (lack < 0){
+         //-- tokens are available already: the timer will fire on the
+         //   next tick
+         lack = 0;
+      }
+
+      _tn_timer_start_at(
+            &rl->timer,
+            rl->last_refill_time + (TN_TickCnt)lack * rl->period
+            );
+   }
+}
+
+/**
+ * Give tokens to the waiting tasks in FIFO order while there are enough
+ * tokens, and then restart the timer for the next waiter (if any).
+ *
+ * Should be called with interrupts disabled, just after `_refill()`.
+ */
+static void _waiters_serve(struct TN_RateLimiter *rl)
+{
+   while (!_tn_list_is_empty(&rl->wait_queue)){
+      struct TN_Task *task = _tn_list_first_entry(
+            &rl->wait_queue, struct TN_Task, task_queue
+            );
+      int tokens_cnt = task->subsys_wait.ratelimit.tokens_cnt;
+
+      if (tokens_cnt > rl->tokens_cnt){
+         //-- not enough tokens for the first waiter yet
+         break;
+      }
+
+      rl->tokens_cnt -= tokens_cnt;
+
+      //-- zero tokens count tells _tn_ratelimit_on_task_wait_complete()
+      //   that the task has got its tokens, so there's no need to restart
+      //   the timer for each woken task: we'll do it once, below.
+      task->subsys_wait.ratelimit.tokens_cnt = 0;
+      _tn_task_wait_complete(task, TN_RC_OK);
+   }
+
+   _timer_restart(rl);
+}
+
+/**
+ * Timer function of the rate limiter: first waiter's tokens have accrued
+ */
+static void _timer_func(struct TN_Timer *timer, void *p_user_data)
+{
+   struct TN_RateLimiter *rl = (struct TN_RateLimiter *)p_user_data;
+
+   //-- since timer callback is called with interrupts enabled,
+   //   we need to disable them before touching the limiter
+   TN_INTSAVE_DATA_INT;
+   TN_INT_IDIS_SAVE();
+
+   _refill(rl);
+   _waiters_serve(rl);
+
+   TN_INT_IRESTORE();
+
+   _TN_UNUSED(timer);
+}
+
+/**
+ * Try to take tokens from the bucket.
+ *
+ * Should be called with interrupts disabled.
+ *
+ * @return
+ *    * `#TN_RC_OK` if tokens are taken;
+ *    * `#TN_RC_TIMEOUT` if there aren't enough tokens, or other tasks
+ *      already wait for tokens.
+ */
+static enum TN_RCode _take(struct TN_RateLimiter *rl, int tokens_cnt)
+{
+   enum TN_RCode rc = TN_RC_TIMEOUT;
+
+   _refill(rl);
+
+   if (     _tn_list_is_empty(&rl->wait_queue)
+         && rl->tokens_cnt >= tokens_cnt
+      )
+   {
+      rl->tokens_cnt -= tokens_cnt;
+      rc = TN_RC_OK;
+   }
+
+   return rc;
+}
+
+
+
+
+/*******************************************************************************
+ *    PUBLIC FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+enum TN_RCode tn_ratelimit_create(
+      struct TN_RateLimiter *rl,
+      int capacity,
+      TN_TickCnt period,
+      int start_tokens_cnt
+      )
+{
+   enum TN_RCode rc = _check_param_create(
+         rl, capacity, period, start_tokens_cnt
+         );
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&(rl->wait_queue));
+      _tn_timer_create(&rl->timer, _timer_func, rl);
+
+      rl->capacity         = capacity;
+      rl->period           = period;
+      rl->tokens_cnt       = start_tokens_cnt;
+      rl->last_refill_time = tn_sys_time_get();
+
+      rl->id_rl = TN_ID_RATE_LIMITER;
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+enum TN_RCode tn_ratelimit_delete(struct TN_RateLimiter *rl)
+{
+   enum TN_RCode rc = _check_param_generic(rl);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      //-- invalidate the object first, so that
+      //   _tn_ratelimit_on_task_wait_complete() doesn't restart the timer
+      //   for each removed task
+      rl->id_rl = TN_ID_NONE;
+
+      //-- Remove all tasks from wait queue, returning the TN_RC_DELETED code.
+      _tn_wait_queue_notify_deleted(&(rl->wait_queue), TN_INTSAVE_VAR);
+
+      _tn_timer_cancel(&rl->timer);
+
+      TN_INT_RESTORE();
+
+      //-- we might need to switch context if _tn_wait_queue_notify_deleted()
+      //   has woken up some high-priority task
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+enum TN_RCode tn_ratelimit_take(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt,
+      TN_TickCnt timeout
+      )
+{
+   TN_BOOL waited = TN_FALSE;
+   enum TN_RCode rc = _check_param_generic(rl);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if ((rc = _check_param_take(rl, tokens_cnt)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      rc = _take(rl, tokens_cnt);
+
+      if (rc == TN_RC_TIMEOUT && timeout != 0){
+         TN_BOOL first = _tn_list_is_empty(&rl->wait_queue);
+
+         _tn_curr_run_task->subsys_wait.ratelimit.tokens_cnt = tokens_cnt;
+         _tn_task_curr_to_wait_action(
+               &(rl->wait_queue), TN_WAIT_REASON_RATELIMIT, timeout
+               );
+
+         if (first){
+            //-- we're the first waiter: start the timer for our tokens
+            _timer_restart(rl);
+         }
+
+         waited = TN_TRUE;
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      if (waited){
+         //-- get wait result
+         rc = _tn_curr_run_task->task_wait_rc;
+      }
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+enum TN_RCode tn_ratelimit_take_polling(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt
+      )
+{
+   return tn_ratelimit_take(rl, tokens_cnt, 0);
+}
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+enum TN_RCode tn_ratelimit_itake_polling(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt
+      )
+{
+   enum TN_RCode rc = _check_param_generic(rl);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if ((rc = _check_param_take(rl, tokens_cnt)) != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA_INT;
+
+      TN_INT_IDIS_SAVE();
+      rc = _take(rl, tokens_cnt);
+      TN_INT_IRESTORE();
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_ratelimit.h)
+ */
+int tn_ratelimit_tokens_cnt_get(struct TN_RateLimiter *rl)
+{
+   int ret = -1;
+   enum TN_RCode rc = _check_param_generic(rl);
+
+   if (rc == TN_RC_OK){
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      _refill(rl);
+      ret = rl->tokens_cnt;
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return ret;
+}
+
+
+
+
+/*******************************************************************************
+ *    PROTECTED FUNCTIONS
+ ******************************************************************************/
+
+/*
+ * See comments in the header file (_tn_ratelimit.h)
+ */
+void _tn_ratelimit_on_task_wait_complete(struct TN_Task *task)
+{
+   struct TN_RateLimiter *rl = _tn_list_entry(
+         task->pwait_queue, struct TN_RateLimiter, wait_queue
+         );
+
+   if (     _tn_ratelimit_is_valid(rl)
+         && task->subsys_wait.ratelimit.tokens_cnt != 0
+      )
+   {
+      //-- the task has left the queue without tokens (timeout, release or
+      //   termination): the next waiter might need another time (or might
+      //   be served right away), so, restart the timer
+      _refill(rl);
+      _timer_restart(rl);
+   }
+}
+
+
+#endif // TN_RATE_LIMITER
+
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
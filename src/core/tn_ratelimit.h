@@ -0,0 +1,277 @@
+/*******************************************************************************
+ *
+ * TNeo: real-time kernel initially based on TNKernel
+ *
+ *    TNKernel:                  copyright 2004, 2013 Yuri Tiomkin.
+ *    PIC32-specific routines:   copyright 2013, 2014 Anders Montonen.
+ *    TNeo:                      copyright 2014       Dmitry Frank.
+ *
+ *    TNeo was born as a thorough review and re-implementation of
+ *    TNKernel. The new kernel has well-formed code, inherited bugs are fixed
+ *    as well as new features being added, and it is tested carefully with
+ *    unit-tests.
+ *
+ *    API is changed somewhat, so it's not 100% compatible with TNKernel,
+ *    hence the new name: TNeo.
+ *
+ *    Permission to use, copy, modify, and distribute this software in source
+ *    and binary forms and its documentation for any purpose and without fee
+ *    is hereby granted, provided that the above copyright notice appear
+ *    in all copies and that both that copyright notice and this permission
+ *    notice appear in supporting documentation.
+ *
+ *    THIS SOFTWARE IS PROVIDED BY THE DMITRY FRANK AND CONTRIBUTORS "AS IS"
+ *    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *    PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL DMITRY FRANK OR CONTRIBUTORS BE
+ *    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ *    THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/**
+ * \file
+ *
+ * Rate limiter: a token bucket.
+ *
+ * The bucket holds up to `capacity` tokens, and it gains one token each
+ * `period` system ticks. The user takes some number of tokens from the
+ * bucket before each rate-limited action (writing the log message, sending
+ * the telemetry packet, etc). If there aren't enough tokens in the bucket,
+ * the task might wait until they accrue (see `tn_ratelimit_take()`), or just
+ * skip the action. So, bursts of up to `capacity` actions are allowed, but
+ * the long-term rate never exceeds one action per `period` ticks.
+ *
+ * The bucket is refilled lazily: there's no periodic timer. Each time the
+ * limiter is accessed, the number of tokens accrued since the last access is
+ * calculated from the current system tick count. The limiter has just one
+ * kernel timer, which is running if only some task waits for tokens: it
+ * fires exactly when the first waiter's tokens have accrued.
+ *
+ * Waiting tasks are served in FIFO order: while some task waits, tokens are
+ * not given to others, even if a smaller amount is available. Otherwise,
+ * tasks that take many tokens at once might starve.
+ *
+ * \attention The refill is calculated from the difference of tick counts,
+ * so if the limiter is not accessed for more than half of the
+ * `#TN_TickCnt` range, the number of accrued tokens may be underestimated.
+ * With `#TN_TICK_CNT_WIDTH` of 32 bits or more, it is rarely an issue.
+ *
+ * Available if only `#TN_RATE_LIMITER` is non-zero.
+ */
+
+#ifndef _TN_RATELIMIT_H
+#define _TN_RATELIMIT_H
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "tn_list.h"
+#include "tn_common.h"
+#include "tn_timer.h"
+
+
+
+#ifdef __cplusplus
+extern "C"  {     /*}*/
+#endif
+
+#if TN_RATE_LIMITER || DOXYGEN_ACTIVE
+
+/*******************************************************************************
+ *    PUBLIC TYPES
+ ******************************************************************************/
+
+/**
+ * Rate limiter
+ */
+struct TN_RateLimiter {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_rl;
+   ///
+   /// List of tasks that wait for tokens
+   struct TN_ListItem wait_queue;
+   ///
+   /// Timer which fires when the first waiter's tokens have accrued
+   struct TN_Timer timer;
+   ///
+   /// Max number of tokens in the bucket
+   int capacity;
+   ///
+   /// Number of tokens in the bucket, as of `last_refill_time`
+   int tokens_cnt;
+   ///
+   /// Number of system ticks needed for one token to accrue
+   TN_TickCnt period;
+   ///
+   /// System tick count at which the last token has accrued (or at which
+   /// the bucket was found full)
+   TN_TickCnt last_refill_time;
+};
+
+/**
+ * Rate limiter-specific fields related to waiting task,
+ * to be included in struct TN_Task.
+ */
+struct TN_RateLimiterTaskWait {
+   /// Number of tokens the task waits for
+   int tokens_cnt;
+};
+
+
+/*******************************************************************************
+ *    PROTECTED GLOBAL DATA
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    DEFINITIONS
+ ******************************************************************************/
+
+/*******************************************************************************
+ *    PUBLIC FUNCTION PROTOTYPES
+ ******************************************************************************/
+
+/**
+ * Construct the rate limiter. `id_rl` field should not contain
+ * `#TN_ID_RATE_LIMITER`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rl
+ *    Pointer to already allocated `struct TN_RateLimiter`
+ * @param capacity
+ *    Max number of tokens in the bucket, i.e. max burst size. Should be
+ *    more than 0.
+ * @param period
+ *    Number of system ticks needed for one token to accrue. Should be
+ *    more than 0, and the time needed for the whole bucket to fill
+ *    (`capacity * period`) should not be more than
+ *    `(#TN_WAIT_INFINITE / 2)`.
+ * @param start_tokens_cnt
+ *    Initial number of tokens in the bucket: from 0 to `capacity`.
+ *
+ * @return 
+ *    * `#TN_RC_OK` if rate limiter was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_ratelimit_create(
+      struct TN_RateLimiter *rl,
+      int capacity,
+      TN_TickCnt period,
+      int start_tokens_cnt
+      );
+
+/**
+ * Destruct the rate limiter.
+ *
+ * All tasks that wait for tokens become runnable with `#TN_RC_DELETED` code
+ * returned.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rl      rate limiter to destruct
+ *
+ * @return 
+ *    * `#TN_RC_OK` if rate limiter was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ratelimit_delete(struct TN_RateLimiter *rl);
+
+/**
+ * Take `tokens_cnt` tokens from the bucket.
+ *
+ * If there are enough tokens in the bucket (and no other task waits for
+ * tokens), they are taken and `#TN_RC_OK` is returned. Otherwise, behavior
+ * depends on `timeout` value: task might switch to $(TN_TASK_STATE_WAIT)
+ * state until the tokens have accrued or until the `timeout` expired. Refer
+ * to `#TN_TickCnt`.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rl            rate limiter
+ * @param tokens_cnt    number of tokens to take: from 1 to `capacity`
+ * @param timeout       refer to `#TN_TickCnt`
+ *
+ * @return
+ *    * `#TN_RC_OK` if tokens were taken;
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_ratelimit_take(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt,
+      TN_TickCnt timeout
+      );
+
+/**
+ * The same as `tn_ratelimit_take()` with zero timeout.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_ratelimit_take_polling(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt
+      );
+
+/**
+ * The same as `tn_ratelimit_take()` with zero timeout, but for using in the
+ * ISR.
+ *
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ */
+enum TN_RCode tn_ratelimit_itake_polling(
+      struct TN_RateLimiter *rl,
+      int tokens_cnt
+      );
+
+/**
+ * Returns number of tokens in the bucket at the moment.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param rl      rate limiter
+ *
+ * @return
+ *    Number of tokens, or -1 if wrong params were given (the check is
+ *    performed if only `#TN_CHECK_PARAM` is non-zero)
+ */
+int tn_ratelimit_tokens_cnt_get(struct TN_RateLimiter *rl);
+
+#endif // TN_RATE_LIMITER
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif // _TN_RATELIMIT_H
+
+/*******************************************************************************
+ *    end of file
+ ******************************************************************************/
+
+
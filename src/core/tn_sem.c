@@ -46,6 +46,8 @@
 //-- internal tnkernel headers
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_async.h"
+#include "_tn_isrrec.h"
 
 
 //-- header of current module
@@ -112,55 +114,74 @@ _TN_STATIC_INLINE enum TN_RCode _check_param_create(
 
 
 /**
- * Generic function that performs job from task context
+ * Performs job from task context, without any checks: parameters and
+ * context should be checked by the caller.
  *
  * @param sem        semaphore to perform job on
  * @param p_worker   pointer to actual worker function
  * @param timeout    see `#TN_TickCnt`
  */
-_TN_STATIC_INLINE enum TN_RCode _sem_job_perform(
+_TN_STATIC_INLINE enum TN_RCode _sem_job_do(
       struct TN_Sem *sem,
       enum TN_RCode (p_worker)(struct TN_Sem *sem),
       TN_TickCnt timeout
       )
 {
-   enum TN_RCode rc = _check_param_generic(sem);
+   enum TN_RCode rc;
    TN_BOOL waited_for_sem = TN_FALSE;
+   TN_INTSAVE_DATA;
 
-   if (rc != TN_RC_OK){
-      //-- just return rc as it is
-   } else if (!tn_is_task_context()){
-      rc = TN_RC_WCONTEXT;
-   } else {
-      TN_INTSAVE_DATA;
-
-      TN_INT_DIS_SAVE();      //-- disable interrupts
-      rc = p_worker(sem);     //-- call actual worker function
+   TN_INT_DIS_SAVE();      //-- disable interrupts
+   rc = p_worker(sem);     //-- call actual worker function
 
-      //-- if we should wait, put current task to wait
-      if (rc == TN_RC_TIMEOUT && timeout != 0){
-         _tn_task_curr_to_wait_action(
-               &(sem->wait_queue), TN_WAIT_REASON_SEM, timeout
-               );
+   //-- if we should wait, put current task to wait
+   if (rc == TN_RC_TIMEOUT && timeout != 0){
+      _tn_task_curr_to_wait_action(
+            &(sem->wait_queue), TN_WAIT_REASON_SEM, timeout
+            );
 
-         //-- rc will be set later thanks to waited_for_sem
-         waited_for_sem = TN_TRUE;
-      }
+      //-- rc will be set later thanks to waited_for_sem
+      waited_for_sem = TN_TRUE;
+   }
 
 #if TN_DEBUG
-      //-- if we're going to wait, _tn_need_context_switch() must return TN_TRUE
-      if (!_tn_need_context_switch() && waited_for_sem){
-         _TN_FATAL_ERROR("");
-      }
+   //-- if we're going to wait, _tn_need_context_switch() must return TN_TRUE
+   if (!_tn_need_context_switch() && waited_for_sem){
+      _TN_FATAL_ERROR("");
+   }
 #endif
 
-      TN_INT_RESTORE();       //-- restore previous interrupts state
-      _tn_context_switch_pend_if_needed();
-      if (waited_for_sem){
-         //-- get wait result
-         rc = _tn_curr_run_task->task_wait_rc;
-      }
+   TN_INT_RESTORE();       //-- restore previous interrupts state
+   _tn_context_switch_pend_if_needed();
+   if (waited_for_sem){
+      //-- get wait result
+      rc = _tn_curr_run_task->task_wait_rc;
+   }
 
+   return rc;
+}
+
+/**
+ * Generic function that performs job from task context
+ *
+ * @param sem        semaphore to perform job on
+ * @param p_worker   pointer to actual worker function
+ * @param timeout    see `#TN_TickCnt`
+ */
+_TN_STATIC_INLINE enum TN_RCode _sem_job_perform(
+      struct TN_Sem *sem,
+      enum TN_RCode (p_worker)(struct TN_Sem *sem),
+      TN_TickCnt timeout
+      )
+{
+   enum TN_RCode rc = _check_param_generic(sem);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      rc = _sem_job_do(sem, p_worker, timeout);
    }
    return rc;
 }
@@ -199,13 +220,19 @@ _TN_STATIC_INLINE enum TN_RCode _sem_signal(struct TN_Sem *sem)
    enum TN_RCode rc = TN_RC_OK;
 
    //-- wake up first (if any) task from the semaphore wait queue
+   //   (if there are no tasks, complete the first asynchronous wait, if any)
    if (  !_tn_task_first_wait_complete(
             &sem->wait_queue, TN_RC_OK,
             TN_NULL, TN_NULL, TN_NULL
             )
+#if TN_ASYNC_WAIT
+         && !_tn_async_first_wait_complete(
+               &sem->async_wait_queue, TN_RC_OK, TN_NULL
+               )
+#endif
       )
    {
-      //-- no tasks are waiting for that semaphore,
+      //-- nobody is waiting for that semaphore,
       //   so, just increase its count if possible.
       if (sem->count < sem->max_count){
          sem->count++;
@@ -258,6 +285,9 @@ enum TN_RCode tn_sem_create(
    } else {
 
       _tn_list_reset(&(sem->wait_queue));
+#if TN_ASYNC_WAIT
+      _tn_list_reset(&(sem->async_wait_queue));
+#endif
 
       sem->count     = start_count;
       sem->max_count = max_count;
@@ -285,7 +315,10 @@ enum TN_RCode tn_sem_delete(struct TN_Sem * sem)
       TN_INT_DIS_SAVE();
 
       //-- Remove all tasks from wait queue, returning the TN_RC_DELETED code.
-      _tn_wait_queue_notify_deleted(&(sem->wait_queue));
+      _tn_wait_queue_notify_deleted(&(sem->wait_queue), TN_INTSAVE_VAR);
+#if TN_ASYNC_WAIT
+      _tn_async_wait_queue_notify_deleted(&(sem->async_wait_queue));
+#endif
 
       sem->id_sem = TN_ID_NONE;        //-- Semaphore does not exist now
       TN_INT_RESTORE();
@@ -310,7 +343,10 @@ enum TN_RCode tn_sem_signal(struct TN_Sem *sem)
  */
 enum TN_RCode tn_sem_isignal(struct TN_Sem *sem)
 {
-   return _sem_job_iperform(sem, _sem_signal);
+   enum TN_RCode rc = _sem_job_iperform(sem, _sem_signal);
+
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_SEM_ISIGNAL, sem, 0, 0, rc);
+   return rc;
 }
 
 /*
@@ -334,7 +370,75 @@ enum TN_RCode tn_sem_wait_polling(struct TN_Sem *sem)
  */
 enum TN_RCode tn_sem_iwait_polling(struct TN_Sem *sem)
 {
-   return _sem_job_iperform(sem, _sem_wait);
+   enum TN_RCode rc = _sem_job_iperform(sem, _sem_wait);
+
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_SEM_IWAIT_POLLING, sem, 0, 0, rc);
+   return rc;
+}
+
+#if TN_FAST_API
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_signal_fast(struct TN_Sem *sem)
+{
+   _TN_BUG_ON(!_tn_sem_is_valid(sem) || !tn_is_task_context());
+
+   return _sem_job_do(sem, _sem_signal, 0);
+}
+
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_wait_fast(struct TN_Sem *sem, TN_TickCnt timeout)
+{
+   _TN_BUG_ON(!_tn_sem_is_valid(sem) || !tn_is_task_context());
+
+   return _sem_job_do(sem, _sem_wait, timeout);
+}
+#endif
+
+#if TN_ASYNC_WAIT
+/*
+ * See comments in the header file (tn_sem.h)
+ */
+enum TN_RCode tn_sem_wait_async(
+      struct TN_Sem *sem,
+      struct TN_AsyncWait *wait
+      )
+{
+   enum TN_RCode rc = _check_param_generic(sem);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (wait == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (_tn_async_wait_is_busy(wait)){
+         rc = TN_RC_WSTATE;
+      } else if (_sem_wait(sem) == TN_RC_OK){
+         //-- semaphore is acquired right away
+         _tn_async_wait_complete(wait, TN_RC_OK, TN_NULL);
+      } else {
+         //-- semaphore isn't available: register the wait
+         _tn_async_wait_add(&(sem->async_wait_queue), wait);
+      }
+
+      TN_INT_RESTORE();
+
+      //-- completion might have woken up the task that waits for the
+      //   completion object
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
 }
+#endif
 
 
@@ -71,6 +71,7 @@
 
 #include "tn_list.h"
 #include "tn_common.h"
+#include "tn_async.h"
 
 
 
@@ -100,6 +101,12 @@ struct TN_Sem {
    ///
    /// Max value of `count`
    int max_count;
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+   ///
+   /// List of asynchronous waiters, see `tn_sem_wait_async()`. Available
+   /// if only `#TN_ASYNC_WAIT` is non-zero.
+   struct TN_ListItem async_wait_queue;
+#endif
 };
 
 
@@ -241,6 +248,77 @@ enum TN_RCode tn_sem_wait_polling(struct TN_Sem *sem);
  */
 enum TN_RCode tn_sem_iwait_polling(struct TN_Sem *sem);
 
+#if TN_FAST_API || DOXYGEN_ACTIVE
+/**
+ * The same as `tn_sem_signal()`, but without checking of parameters and
+ * context, no matter `#TN_CHECK_PARAM`: intended for the measured hot
+ * paths. The semaphore should be valid, and the function should be called
+ * from task only; with `#TN_DEBUG`, violation leads to `_TN_FATAL_ERROR()`,
+ * otherwise the behavior is undefined.
+ *
+ * Available if only `#TN_FAST_API` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    * `#TN_RC_OK` if successful
+ *    * `#TN_RC_OVERFLOW` if `count` is already at maximum value (`max_count`)
+ */
+enum TN_RCode tn_sem_signal_fast(struct TN_Sem *sem);
+
+/**
+ * The same as `tn_sem_wait()`, but without checking of parameters and
+ * context, see `tn_sem_signal_fast()`.
+ *
+ * Available if only `#TN_FAST_API` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_CAN_SLEEP)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    * `#TN_RC_OK` if waiting was successfull
+ *    * Other possible return codes depend on `timeout` value,
+ *      refer to `#TN_TickCnt`
+ */
+enum TN_RCode tn_sem_wait_fast(struct TN_Sem *sem, TN_TickCnt timeout);
+#endif
+
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+/**
+ * Asynchronous version of `tn_sem_wait()`: it never blocks.
+ *
+ * If the current semaphore counter is non-zero, it is decremented, and the
+ * wait is completed right away. Otherwise, the wait is registered in the
+ * semaphore, and it is completed by `tn_sem_signal()` (when there are no
+ * tasks blocked on the semaphore). Refer to tn_async.h for details.
+ *
+ * Available if only `#TN_ASYNC_WAIT` is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param sem     semaphore to wait for
+ * @param wait    waiter node, see `tn_async_wait_init()`
+ *
+ * @return
+ *    * `#TN_RC_OK` if the wait is registered (or completed right away);
+ *    * `#TN_RC_WSTATE` if the wait is already pending, or it is completed
+ *      but isn't taken from the completion object yet;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_sem_wait_async(
+      struct TN_Sem *sem,
+      struct TN_AsyncWait *wait
+      );
+#endif
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
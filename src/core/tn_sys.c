@@ -54,6 +54,8 @@
 #include "_tn_timer.h"
 #include "_tn_tasks.h"
 #include "_tn_list.h"
+#include "_tn_mutex.h"
+#include "_tn_isrrec.h"
 
 
 #include "tn_tasks.h"
@@ -99,12 +101,22 @@ volatile enum TN_StateFlag _tn_sys_state;
 // See comments in the internal/_tn_sys.h file
 struct TN_Task *_tn_next_task_to_run;
 
+#if TN_LAZY_SCHED
+// See comments in the internal/_tn_sys.h file
+volatile TN_BOOL _tn_next_task_dirty;
+#endif
+
 // See comments in the internal/_tn_sys.h file
 struct TN_Task *_tn_curr_run_task;
 
 // See comments in the internal/_tn_sys.h file
 volatile unsigned int _tn_ready_to_run_bmp;
 
+#if TN_TIME_PARTITIONS
+// See comments in the internal/_tn_sys.h file
+volatile unsigned int _tn_ready_to_run_mask;
+#endif
+
 // See comments in the internal/_tn_sys.h file
 struct TN_Task _tn_idle_task;
 
@@ -136,6 +148,13 @@ TN_CBStackOverflow *_tn_cb_stack_overflow = TN_NULL;
 /// (see `#TN_MUTEX_DEADLOCK_DETECT`)
 TN_CBDeadlock *_tn_cb_deadlock = TN_NULL;
 
+#if TN_MUTEX_CEIL_LEARN
+/// User-provided callback function that gets called whenever some task
+/// violates the mutex priority ceiling.
+/// (see `#TN_MUTEX_CEIL_LEARN`)
+TN_CBMutexCeilViolation *_tn_cb_mutex_ceil_violation = TN_NULL;
+#endif
+
 /// Time slice values for each available priority, in system ticks.
 unsigned short _tn_tslice_ticks[TN_PRIORITIES_CNT];
 
@@ -144,6 +163,40 @@ unsigned short _tn_tslice_ticks[TN_PRIORITIES_CNT];
 int _tn_deadlocks_cnt = 0;
 #endif
 
+#if TN_TIME_PARTITIONS
+/// Time windows of the major frame, see `tn_sys_time_windows_set()`
+const struct TN_TimeWindow *_tn_time_windows = TN_NULL;
+
+/// Number of items in `_tn_time_windows`; 0 if partitioning is off.
+int _tn_time_windows_cnt = 0;
+
+/// Index of the current time window
+int _tn_time_window_cur = 0;
+
+/// System tick count at which the current time window has started
+TN_TickCnt _tn_time_window_start_tick = 0;
+
+/// Priorities which are eligible in every time window
+unsigned int _tn_time_always_prio_mask = 0;
+
+/// Timer which switches time windows
+struct TN_Timer _tn_time_window_timer;
+#endif
+
+#if TN_IDLE_GOVERNOR
+/// Sleep states for the idle governor, see `tn_sys_sleep_states_set()`
+struct TN_SleepState *_tn_sleep_states = TN_NULL;
+
+/// Number of items in `_tn_sleep_states`; 0 if the governor is off.
+int _tn_sleep_states_cnt = 0;
+#endif
+
+#if TN_HYBRID_TICK
+/// Callback which suppresses the tick while idle, see
+/// `tn_callback_tick_suppress_set()`
+TN_CBTickSuppress *_tn_cb_tick_suppress = TN_NULL;
+#endif
+
 
 /*******************************************************************************
  *    PRIVATE DATA
@@ -164,6 +217,100 @@ extern void you_should_add_file___tn_app_check_c___to_the_project(void);
  *    PRIVATE FUNCTIONS
  ******************************************************************************/
 
+#if TN_IDLE_GOVERNOR
+/**
+ * Called from the idle task: pick the lowest-power sleep state which fits
+ * the time until the next kernel deadline, and enter it.
+ */
+static void _idle_governor_run(void)
+{
+   TN_INTSAVE_DATA;
+
+   TN_INT_DIS_SAVE();
+
+   //-- if some task has just become runnable, don't sleep at all
+   if (_tn_sleep_states_cnt > 0 && !_tn_need_context_switch()){
+      TN_TickCnt time_left = _tn_timer_next_timeout_get();
+      struct TN_SleepState *state = TN_NULL;
+      int i;
+
+      for (i = 0; i < _tn_sleep_states_cnt; i++){
+         struct TN_SleepState *cur = &_tn_sleep_states[i];
+
+         //-- NOTE: when there are no active timeouts, time_left is
+         //   TN_WAIT_INFINITE, so, any state fits
+         if (     (time_left == TN_WAIT_INFINITE
+                  || (time_left >= cur->latency
+                     && time_left - cur->latency >= cur->min_residency))
+               && (state == TN_NULL || cur->power < state->power)
+            )
+         {
+            state = cur;
+         }
+      }
+
+      if (state != TN_NULL){
+         TN_TickCnt slept = state->enter(
+               (time_left == TN_WAIT_INFINITE)
+               ? TN_WAIT_INFINITE
+               : (TN_TickCnt)(time_left - state->latency)
+               );
+
+         state->entries_cnt++;
+         state->residency += slept;
+
+         if (state->tick_stopped){
+            _tn_timer_tick_compensate(slept);
+         }
+      }
+   }
+
+   TN_INT_RESTORE();
+}
+#else
+#  define _idle_governor_run()   /* nothing */
+#endif
+
+#if TN_HYBRID_TICK
+/**
+ * Called from the idle task: if the nearest timer expires not in the next
+ * tick, stop the periodic tick until then (by the application callback),
+ * and catch up the skipped ticks.
+ */
+static void _tick_suppress_run(void)
+{
+   TN_INTSAVE_DATA;
+
+   TN_INT_DIS_SAVE();
+
+   //-- if some task has just become runnable, don't suppress the tick
+   if (_tn_cb_tick_suppress != TN_NULL && !_tn_need_context_switch()){
+      TN_TickCnt time_left = _tn_timer_next_timeout_get();
+
+      //-- the tick at which the nearest timer expires is handled by the
+      //   tick interrupt as usual, so that timer callbacks are called
+      //   from the ISR context
+      if (time_left > 1){
+         TN_TickCnt max_ticks = (time_left == TN_WAIT_INFINITE)
+            ? TN_WAIT_INFINITE
+            : (TN_TickCnt)(time_left - 1);
+
+         TN_TickCnt skipped = _tn_cb_tick_suppress(max_ticks);
+
+         if (skipped > max_ticks){
+            _TN_FATAL_ERROR("too many ticks skipped");
+         } else if (skipped > 0){
+            _tn_timer_tick_catch_up(skipped);
+         }
+      }
+   }
+
+   TN_INT_RESTORE();
+}
+#else
+#  define _tick_suppress_run()   /* nothing */
+#endif
+
 /**
  * Idle task body. In fact, this task is always in RUNNABLE state.
  */
@@ -172,7 +319,25 @@ static void _idle_task_body(void *par)
    //-- enter endless loop with calling user-provided hook function
    for(;;)
    {
+#if TN_STACK_FILL_LAZY
+      //-- finish filling task stacks with TN_FILL_STACK_VAL (if needed)
+      //   before calling user hook which might put the processor to sleep.
+      //   Interrupts are enabled between the chunks.
+      while (_tn_task_stack_fill_lazy_step()){
+         //-- keep filling
+      }
+#endif
+      //-- check for deadlocks (if detection is deferred to the idle task)
+      _tn_mutex_deadlock_check_deferred();
+
       _tn_cb_idle_hook();
+
+      //-- put MCU to the appropriate sleep state (if idle governor is used)
+      _idle_governor_run();
+
+      //-- stop the tick until the next timer expiration (if hybrid tick
+      //   is used)
+      _tick_suppress_run();
    }
    _TN_UNUSED(par);
 }
@@ -188,25 +353,51 @@ _TN_STATIC_INLINE void _round_robin_manage(void) {
     */
 }
 
+#elif !TN_PREEMPTIVE
+
+_TN_STATIC_INLINE void _round_robin_manage(void) {
+   //-- in cooperative mode, tasks are never preempted, so there's
+   //   nothing to do: tasks give up CPU by tn_task_yield() instead.
+}
+
 #else
 
 _TN_STATIC_INLINE void _round_robin_manage(void)
 {
+   //-- timers might have changed the state of some tasks
+   _tn_next_task_resolve();
+
    //-- Manage round robin if only context switch is not already needed for
    //   some other reason
    if (_tn_curr_run_task == _tn_next_task_to_run) {
       //-- volatile is used here only to solve
       //   IAR(c) compiler's high optimization mode problem
+#if !TN_FAIR_SHARE
       _TN_VOLATILE_WORKAROUND struct TN_ListItem *curr_que;
       _TN_VOLATILE_WORKAROUND struct TN_ListItem *pri_queue;
+#endif
       _TN_VOLATILE_WORKAROUND int priority = _tn_curr_run_task->priority;
 
       if (_tn_tslice_ticks[priority] != TN_NO_TIME_SLICE){
          _tn_curr_run_task->tslice_count++;
 
+#if TN_FAIR_SHARE
+         //-- charge current task for the tick it was running
+         _tn_curr_run_task->fs_vruntime += _tn_curr_run_task->fs_vruntime_inc;
+#endif
+
          if (_tn_curr_run_task->tslice_count >= _tn_tslice_ticks[priority]){
             _tn_curr_run_task->tslice_count = 0;
 
+#if TN_FAIR_SHARE
+            //-- instead of just moving the task to the tail of the ready
+            //   queue, put it according to its virtual run time
+            _tn_task_fair_share_requeue(_tn_curr_run_task);
+
+            _tn_next_task_to_run = _tn_get_task_by_tsk_queue(
+                  _tn_tasks_ready_list[priority].next
+                  );
+#else
             pri_queue = &(_tn_tasks_ready_list[priority]);
             //-- If ready queue is not empty and there are more than 1 
             //   task in the queue
@@ -224,6 +415,7 @@ _TN_STATIC_INLINE void _round_robin_manage(void)
                      _tn_tasks_ready_list[priority].next
                      );
             }
+#endif
          }
       }
    }
@@ -232,8 +424,94 @@ _TN_STATIC_INLINE void _round_robin_manage(void)
 #endif
 
 
+#if TN_TIME_PARTITIONS
+/**
+ * Activate current time window `_tn_time_window_cur`: set the mask of
+ * eligible priorities, find next task to run and start the timer which
+ * will switch to the next window.
+ *
+ * Interrupts should be disabled when calling it.
+ */
+static void _time_window_apply(void)
+{
+   const struct TN_TimeWindow *window = &_tn_time_windows[_tn_time_window_cur];
+
+   //-- idle task is always eligible
+   _tn_ready_to_run_mask = 0
+      | window->prio_mask
+      | _tn_time_always_prio_mask
+      | (1 << (TN_PRIORITIES_CNT - 1))
+      ;
+
+   _tn_task_next_to_run_find();
+
+   //-- the switch tick is calculated from the start tick of the current
+   //   window, not from the current time: with dynamic tick, the callback
+   //   might be called some time after the expiration tick, and this delay
+   //   shouldn't shift the whole frame.
+   _tn_timer_start_at(
+         &_tn_time_window_timer,
+         _tn_time_window_start_tick + window->duration
+         );
+}
+
+/**
+ * Callback of `_tn_time_window_timer`: switch to the next time window.
+ * It is called from the $(TN_SYS_TIMER_LINK) interrupt, which pends context
+ * switch (if needed) when all timers are handled.
+ */
+static void _time_window_switch(struct TN_Timer *timer, void *p_user_data)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   _TN_UNUSED(timer);
+   _TN_UNUSED(p_user_data);
+
+   //-- time windows might be turned off while the callback was pending
+   if (_tn_time_windows_cnt > 0){
+      _tn_time_window_start_tick
+         += _tn_time_windows[_tn_time_window_cur].duration;
+
+      _tn_time_window_cur++;
+      if (_tn_time_window_cur >= _tn_time_windows_cnt){
+         _tn_time_window_cur = 0;
+      }
+
+      _time_window_apply();
+   }
+
+   tn_arch_sr_restore(sr_saved);
+}
+#endif
+
+
 #if _TN_ON_CONTEXT_SWITCH_HANDLER
 #if TN_PROFILER
+#if TN_PROFILER_LIGHT
+/**
+ * Add value to the 32-bit accumulator of the lightweight profiler (see
+ * `#TN_PROFILER_LIGHT`). If the accumulator would overflow, it is folded
+ * into the 64-bit total right away; it happens rarely, so 64-bit arithmetic
+ * costs nearly nothing on average.
+ */
+_TN_STATIC_INLINE void _profiler_acc_add(
+      unsigned long        *p_acc,
+      unsigned long long   *p_total,
+      unsigned long         value
+      )
+{
+   unsigned long acc = *p_acc + value;
+
+   if (acc < value){
+      //-- overflow: fold the accumulator
+      *p_total += (unsigned long long)*p_acc + value;
+      acc = 0;
+   }
+
+   *p_acc = acc;
+}
+#endif
+
 /**
  * This function is called at every context switch, if `#TN_PROFILER` is 
  * non-zero.
@@ -268,7 +546,15 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
          = (TN_TickCnt)(cur_tick_cnt - task_prev->profiler.last_tick_cnt);
 
       //-- add it to total run time
+#if TN_PROFILER_LIGHT
+      _profiler_acc_add(
+            &task_prev->profiler.run_time_acc,
+            &task_prev->profiler.timing.total_run_time,
+            (unsigned long)cur_run_time
+            );
+#else
       task_prev->profiler.timing.total_run_time += cur_run_time;
+#endif
 
       //-- check if we should update consecutive max run time
       if (task_prev->profiler.timing.max_consecutive_run_time < cur_run_time){
@@ -299,9 +585,19 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
          = (TN_TickCnt)(cur_tick_cnt - task_new->profiler.last_tick_cnt);
 
       //-- add it to total total_wait_time for particular wait reason
+#if TN_PROFILER_LIGHT
+      _profiler_acc_add(
+            &task_new->profiler.wait_time_acc
+            [ task_new->profiler.last_wait_reason ],
+            &task_new->profiler.timing.total_wait_time
+            [ task_new->profiler.last_wait_reason ],
+            (unsigned long)cur_wait_time
+            );
+#else
       task_new->profiler.timing.total_wait_time
          [ task_new->profiler.last_wait_reason ] 
          += cur_wait_time;
+#endif
 
       //-- check if we should update consecutive max wait time
       if (
@@ -315,7 +611,15 @@ _TN_STATIC_INLINE void _tn_sys_on_context_switch_profiler(
 #endif
 
       //-- increment the counter of times task got running
+#if TN_PROFILER_LIGHT
+      _profiler_acc_add(
+            &task_new->profiler.got_running_cnt_acc,
+            &task_new->profiler.timing.got_running_cnt,
+            1
+            );
+#else
       task_new->profiler.timing.got_running_cnt++;
+#endif
 
       //-- update current task state
       task_new->profiler.last_tick_cnt      = cur_tick_cnt;
@@ -482,6 +786,68 @@ static void _build_cfg_check(void)
       _TN_FATAL_ERROR("TN_OLD_EVENT_API doesn't match");
    }
 
+   if (kernel_build_cfg.tick_cnt_width_div_16 != app_build_cfg->tick_cnt_width_div_16){
+      _TN_FATAL_ERROR("TN_TICK_CNT_WIDTH doesn't match");
+   }
+
+   if (kernel_build_cfg.stack_fill_lazy != app_build_cfg->stack_fill_lazy){
+      _TN_FATAL_ERROR("TN_STACK_FILL_LAZY doesn't match");
+   }
+
+   if (kernel_build_cfg.preemptive != app_build_cfg->preemptive){
+      _TN_FATAL_ERROR("TN_PREEMPTIVE doesn't match");
+   }
+
+   if (kernel_build_cfg.fair_share != app_build_cfg->fair_share){
+      _TN_FATAL_ERROR("TN_FAIR_SHARE doesn't match");
+   }
+
+   if (kernel_build_cfg.task_groups != app_build_cfg->task_groups){
+      _TN_FATAL_ERROR("TN_TASK_GROUPS doesn't match");
+   }
+
+   if (kernel_build_cfg.time_partitions != app_build_cfg->time_partitions){
+      _TN_FATAL_ERROR("TN_TIME_PARTITIONS doesn't match");
+   }
+
+   if (kernel_build_cfg.task_release_table != app_build_cfg->task_release_table){
+      _TN_FATAL_ERROR("TN_TASK_RELEASE_TABLE doesn't match");
+   }
+
+   if (kernel_build_cfg.idle_governor != app_build_cfg->idle_governor){
+      _TN_FATAL_ERROR("TN_IDLE_GOVERNOR doesn't match");
+   }
+
+   if (kernel_build_cfg.lazy_timeout != app_build_cfg->lazy_timeout){
+      _TN_FATAL_ERROR("TN_LAZY_TIMEOUT doesn't match");
+   }
+
+   if (     kernel_build_cfg.mutex_deadlock_detect_defer 
+         != app_build_cfg->mutex_deadlock_detect_defer)
+   {
+      _TN_FATAL_ERROR("TN_MUTEX_DEADLOCK_DETECT_DEFER doesn't match");
+   }
+
+   if (kernel_build_cfg.async_wait != app_build_cfg->async_wait){
+      _TN_FATAL_ERROR("TN_ASYNC_WAIT doesn't match");
+   }
+
+   if (kernel_build_cfg.rate_limiter != app_build_cfg->rate_limiter){
+      _TN_FATAL_ERROR("TN_RATE_LIMITER doesn't match");
+   }
+
+   if (kernel_build_cfg.queue_match != app_build_cfg->queue_match){
+      _TN_FATAL_ERROR("TN_QUEUE_MATCH doesn't match");
+   }
+
+   if (kernel_build_cfg.profiler_light != app_build_cfg->profiler_light){
+      _TN_FATAL_ERROR("TN_PROFILER_LIGHT doesn't match");
+   }
+
+   if (kernel_build_cfg.mutex_ceil_learn != app_build_cfg->mutex_ceil_learn){
+      _TN_FATAL_ERROR("TN_MUTEX_CEIL_LEARN doesn't match");
+   }
+
 #if defined (__TN_ARCH_PIC24_DSPIC__)
    if (kernel_build_cfg.arch.p24.p24_sys_ipl != app_build_cfg->arch.p24.p24_sys_ipl){
       _TN_FATAL_ERROR("TN_P24_SYS_IPL doesn't match");
@@ -550,6 +916,12 @@ void tn_sys_start(
    //-- reset bitmask of priorities with runnable tasks
    _tn_ready_to_run_bmp = 0;
 
+#if TN_TIME_PARTITIONS
+   //-- until time windows are set, all priorities are eligible
+   _tn_ready_to_run_mask = ~0u;
+   _tn_timer_create(&_tn_time_window_timer, _time_window_switch, TN_NULL);
+#endif
+
    //-- reset pointers to currently running task and next task to run
    _tn_next_task_to_run = TN_NULL;
    _tn_curr_run_task    = TN_NULL;
@@ -605,6 +977,9 @@ void tn_sys_start(
    //   (well, it will be running soon actually)
    _tn_sys_state |= TN_STATE_FLAG__SYS_RUNNING;
 
+   //-- user's callback might have made some tasks runnable
+   _tn_next_task_resolve();
+
    //-- call architecture-dependent initialization and run the kernel:
    //   (perform first context switch)
    _tn_arch_sys_start(int_stack, int_stack_size);
@@ -635,6 +1010,8 @@ void tn_tick_int_processing(void)
 
    TN_INT_IRESTORE();
    _TN_CONTEXT_SWITCH_IPEND_IF_NEEDED();
+
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_TICK, TN_NULL, 0, 0, TN_RC_OK);
 }
 
 /*
@@ -661,6 +1038,150 @@ enum TN_RCode tn_sys_tslice_set(int priority, int ticks)
    return rc;
 }
 
+#if TN_IDLE_GOVERNOR
+/*
+ * See comments in the header file (tn_sys.h)
+ */
+enum TN_RCode tn_sys_sleep_states_set(
+      struct TN_SleepState *states,
+      int states_cnt
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   int i;
+
+   if (states_cnt < 0 || (states_cnt > 0 && states == TN_NULL)){
+      rc = TN_RC_WPARAM;
+   } else {
+      for (i = 0; i < states_cnt; i++){
+         if (states[i].enter == TN_NULL){
+            rc = TN_RC_WPARAM;
+            break;
+         }
+      }
+   }
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+      for (i = 0; i < states_cnt; i++){
+         states[i].entries_cnt  = 0;
+         states[i].residency    = 0;
+      }
+
+      _tn_sleep_states     = states;
+      _tn_sleep_states_cnt = states_cnt;
+
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
+#endif
+
+#if TN_IDLE_GOVERNOR || TN_HYBRID_TICK
+/*
+ * See comments in the header file (tn_sys.h)
+ */
+TN_TickCnt tn_sys_next_deadline_get(void)
+{
+   TN_TickCnt ret;
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   ret = _tn_timer_next_timeout_get();
+
+   tn_arch_sr_restore(sr_saved);
+
+   return ret;
+}
+#endif
+
+#if TN_HYBRID_TICK
+/*
+ * See comments in the header file (tn_sys.h)
+ */
+enum TN_RCode tn_callback_tick_suppress_set(
+      TN_CBTickSuppress *cb_tick_suppress
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (tn_is_isr_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+      _tn_cb_tick_suppress = cb_tick_suppress;
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+#endif
+
+#if TN_TIME_PARTITIONS
+/*
+ * See comments in the header file (tn_sys.h)
+ */
+enum TN_RCode tn_sys_time_windows_set(
+      const struct TN_TimeWindow *windows,
+      int windows_cnt,
+      unsigned int always_prio_mask
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+   int i;
+
+   if (windows_cnt < 0 || (windows_cnt > 0 && windows == TN_NULL)){
+      rc = TN_RC_WPARAM;
+   } else {
+      for (i = 0; i < windows_cnt; i++){
+         if (     windows[i].duration == 0
+               || windows[i].duration > (TN_WAIT_INFINITE >> 1))
+         {
+            rc = TN_RC_WPARAM;
+            break;
+         }
+      }
+   }
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      _tn_timer_cancel(&_tn_time_window_timer);
+
+      _tn_time_windows           = windows;
+      _tn_time_windows_cnt       = windows_cnt;
+      _tn_time_window_cur        = 0;
+      _tn_time_window_start_tick = _tn_timer_sys_time_get();
+      _tn_time_always_prio_mask  = always_prio_mask;
+
+      if (windows_cnt > 0){
+         _time_window_apply();
+      } else {
+         //-- partitioning is turned off: all priorities are eligible
+         _tn_ready_to_run_mask = ~0u;
+         _tn_task_next_to_run_find();
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+   }
+
+   return rc;
+}
+#endif
+
 /*
  * See comments in the header file (tn_sys.h)
  */
@@ -692,6 +1213,16 @@ void tn_callback_deadlock_set(TN_CBDeadlock *cb)
    _tn_cb_deadlock = cb;
 }
 
+#if TN_MUTEX_CEIL_LEARN
+/*
+ * See comment in tn_sys.h file
+ */
+void tn_callback_mutex_ceil_violation_set(TN_CBMutexCeilViolation *cb)
+{
+   _tn_cb_mutex_ceil_violation = cb;
+}
+#endif
+
 /*
  * See comment in tn_sys.h file
  */
@@ -757,31 +1288,71 @@ void tn_callback_dyn_tick_set(
 /**
  * See comment in the _tn_sys.h file
  */
-void _tn_wait_queue_notify_deleted(struct TN_ListItem *wait_queue)
+void _tn_wait_queue_notify_deleted(
+      struct TN_ListItem *wait_queue,
+      TN_UWord TN_INTSAVE_VAR
+      )
 {
-   struct TN_Task *task;         //-- "cursor" for the loop iteration
-   struct TN_Task *tmp_task;     //-- we need for temporary item because
-                                 //   item is removed from the list
-                                 //   in _tn_mutex_do_unlock().
+   int items_cnt = 0;
 
-
-   //-- iterate through all tasks in the wait_queue,
+   //-- take tasks from the head of the wait_queue one by one,
    //   calling _tn_task_wait_complete() for each task,
    //   and setting TN_RC_DELETED as a wait return code.
-   _tn_list_for_each_entry_safe(
-         task, struct TN_Task, tmp_task, wait_queue, task_queue 
-         )
-   {
+   //
+   //   NOTE: we don't iterate with `_tn_list_for_each_entry_safe()` here,
+   //   because some task might be removed from the queue by the timeout
+   //   while interrupts are enabled in _tn_sys_preempt_point(): so, we just
+   //   re-read the head every time.
+   while (!_tn_list_is_empty(wait_queue)){
+      struct TN_Task *task = _tn_list_first_entry(
+            wait_queue, struct TN_Task, task_queue
+            );
+
       //-- call _tn_task_wait_complete for every task
+      //   (it removes task from the wait_queue)
       _tn_task_wait_complete(task, TN_RC_DELETED);
-   }
 
-#if TN_DEBUG
-   if (!_tn_list_is_empty(wait_queue)){
-      _TN_FATAL_ERROR("");
+      _tn_sys_preempt_point(&items_cnt, TN_INTSAVE_VAR);
    }
+
+   _tn_sys_preempt_points_done();
+}
+
+#if TN_PREEMPT_POINT_ITEMS
+/**
+ * See comment in the _tn_sys.h file
+ */
+void _tn_sys_preempt_point(int *p_items_cnt, TN_UWord TN_INTSAVE_VAR)
+{
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   (*p_items_cnt)++;
+
+   if (*p_items_cnt >= TN_PREEMPT_POINT_ITEMS){
+      *p_items_cnt = 0;
+
+#if _TN_ARCH_SCHED_DIS_KEEPS_INT
+      if (!_tn_arch_inside_isr()){
+         //-- disable scheduler, so that context switch can't happen
+         //   while interrupts are enabled (if some ISR pends it, it
+         //   will happen when the caller restores interrupts)
+         TN_UWord sched_state = tn_arch_sched_dis_save();
+
+         //-- let pending interrupts get served: restore interrupts
+         //   to the state saved by the caller (if the caller was called
+         //   with interrupts disabled, they stay disabled)
+         TN_INT_RESTORE();
+         TN_INT_DIS_SAVE();
+
+         tn_arch_sched_restore(sched_state);
+      }
+#else
+      _TN_UNUSED(TN_INTSAVE_VAR);
 #endif
+   }
 }
+#endif
 
 /**
  * See comments in the file _tn_sys.h
@@ -835,6 +1406,18 @@ void _tn_cry_deadlock(TN_BOOL active, struct TN_Mutex *mutex, struct TN_Task *ta
 }
 #endif
 
+#if TN_MUTEX_CEIL_LEARN
+/**
+ * See comments in the file _tn_sys.h
+ */
+void _tn_cry_mutex_ceil_violation(struct TN_Mutex *mutex, struct TN_Task *task)
+{
+   if (_tn_cb_mutex_ceil_violation != TN_NULL){
+      _tn_cb_mutex_ceil_violation(mutex, task);
+   }
+}
+#endif
+
 #if _TN_ON_CONTEXT_SWITCH_HANDLER
 /*
  * See comments in the file _tn_sys.h
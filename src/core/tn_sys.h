@@ -133,6 +133,22 @@ struct TN_Mutex;
    (_p_struct)->stack_overflow_check      = TN_STACK_OVERFLOW_CHECK;    \
    (_p_struct)->dynamic_tick              = TN_DYNAMIC_TICK;            \
    (_p_struct)->old_events_api            = TN_OLD_EVENT_API;           \
+   (_p_struct)->tick_cnt_width_div_16     = (TN_TICK_CNT_WIDTH / 16);   \
+   (_p_struct)->stack_fill_lazy           = TN_STACK_FILL_LAZY;         \
+   (_p_struct)->preemptive                = TN_PREEMPTIVE;              \
+   (_p_struct)->fair_share                = TN_FAIR_SHARE;              \
+   (_p_struct)->task_groups               = TN_TASK_GROUPS;             \
+   (_p_struct)->time_partitions           = TN_TIME_PARTITIONS;         \
+   (_p_struct)->task_release_table        = TN_TASK_RELEASE_TABLE;      \
+   (_p_struct)->idle_governor             = TN_IDLE_GOVERNOR;           \
+   (_p_struct)->lazy_timeout              = TN_LAZY_TIMEOUT;            \
+   (_p_struct)->mutex_deadlock_detect_defer                             \
+                                       = TN_MUTEX_DEADLOCK_DETECT_DEFER;\
+   (_p_struct)->async_wait                = TN_ASYNC_WAIT;              \
+   (_p_struct)->rate_limiter              = TN_RATE_LIMITER;            \
+   (_p_struct)->queue_match               = TN_QUEUE_MATCH;             \
+   (_p_struct)->profiler_light            = TN_PROFILER_LIGHT;          \
+   (_p_struct)->mutex_ceil_learn          = TN_MUTEX_CEIL_LEARN;        \
                                                                         \
    _TN_BUILD_CFG_ARCH_STRUCT_FILL(_p_struct);                           \
 }
@@ -209,6 +225,51 @@ struct _TN_BuildCfg {
    /// Value of `#TN_OLD_EVENT_API`
    unsigned          old_events_api             : 1;
    ///
+   /// Value of `#TN_TICK_CNT_WIDTH` divided by 16
+   unsigned          tick_cnt_width_div_16      : 3;
+   ///
+   /// Value of `#TN_STACK_FILL_LAZY`
+   unsigned          stack_fill_lazy            : 1;
+   ///
+   /// Value of `#TN_PREEMPTIVE`
+   unsigned          preemptive                 : 1;
+   ///
+   /// Value of `#TN_FAIR_SHARE`
+   unsigned          fair_share                 : 1;
+   ///
+   /// Value of `#TN_TASK_GROUPS`
+   unsigned          task_groups                : 1;
+   ///
+   /// Value of `#TN_TIME_PARTITIONS`
+   unsigned          time_partitions            : 1;
+   ///
+   /// Value of `#TN_TASK_RELEASE_TABLE`
+   unsigned          task_release_table         : 1;
+   ///
+   /// Value of `#TN_IDLE_GOVERNOR`
+   unsigned          idle_governor              : 1;
+   ///
+   /// Value of `#TN_LAZY_TIMEOUT`
+   unsigned          lazy_timeout               : 1;
+   ///
+   /// Value of `#TN_MUTEX_DEADLOCK_DETECT_DEFER`
+   unsigned          mutex_deadlock_detect_defer: 1;
+   ///
+   /// Value of `#TN_ASYNC_WAIT`
+   unsigned          async_wait                 : 1;
+   ///
+   /// Value of `#TN_RATE_LIMITER`
+   unsigned          rate_limiter               : 1;
+   ///
+   /// Value of `#TN_QUEUE_MATCH`
+   unsigned          queue_match                : 1;
+   ///
+   /// Value of `#TN_PROFILER_LIGHT`
+   unsigned          profiler_light             : 1;
+   ///
+   /// Value of `#TN_MUTEX_CEIL_LEARN`
+   unsigned          mutex_ceil_learn           : 1;
+   ///
    /// Architecture-dependent values
    union {
       ///
@@ -353,6 +414,137 @@ typedef void (TN_CBDeadlock)(
       struct TN_Task *task
       );
 
+#if TN_MUTEX_CEIL_LEARN || DOXYGEN_ACTIVE
+/**
+ * User-provided callback function that is called whenever some task tries
+ * to lock the mutex with `#TN_MUTEX_PROT_CEILING` protocol while the task's
+ * base priority is higher than the mutex ceiling (such `tn_mutex_lock()`
+ * returns `#TN_RC_ILLEGAL_USE`).
+ * Note: this feature works if only `#TN_MUTEX_CEIL_LEARN` is non-zero.
+ *
+ * The callback is called from the context of the offending task, with
+ * interrupts disabled, so it should be short: say, just log the event.
+ *
+ * @param mutex
+ *    mutex whose ceiling is violated
+ *
+ * @param task
+ *    task that tried to lock the mutex
+ */
+typedef void (TN_CBMutexCeilViolation)(
+      struct TN_Mutex *mutex,
+      struct TN_Task *task
+      );
+#endif
+
+#if TN_IDLE_GOVERNOR || DOXYGEN_ACTIVE
+/**
+ * Prototype of the function which puts MCU into some sleep state, see
+ * `struct #TN_SleepState`.
+ *
+ * It is called from the idle task with interrupts disabled, and it should
+ * enter the sleep state in such a way that any pending interrupt wakes the
+ * MCU up (say, on Cortex-M, `WFI` wakes up even if interrupts are disabled
+ * by `PRIMASK`); then, return. The kernel enables interrupts afterwards.
+ *
+ * @param max_ticks
+ *    Maximum time to sleep, in system ticks (the state latency is already
+ *    subtracted). It might be `#TN_WAIT_INFINITE` if there are no active
+ *    timeouts at all.
+ *
+ * @return
+ *    Number of system ticks actually spent in the sleep state. It is used
+ *    for residency accounting, and, if the state stops the tick counter
+ *    (see `TN_SleepState::tick_stopped`), for tick compensation.
+ */
+typedef TN_TickCnt (TN_CBSleepEnter)(TN_TickCnt max_ticks);
+
+/**
+ * Sleep state of the MCU, used by the idle governor, see
+ * `tn_sys_sleep_states_set()`.
+ *
+ * Available if only `#TN_IDLE_GOVERNOR` option is non-zero.
+ */
+struct TN_SleepState {
+   ///
+   /// State name for debug purposes, may be `TN_NULL`
+   const char *name;
+   ///
+   /// Entry + exit latency, in system ticks: the state is entered so that
+   /// MCU wakes up this time before the next kernel deadline.
+   TN_TickCnt latency;
+   ///
+   /// Minimum time in the state (not including latency), in system ticks,
+   /// for which entering it makes sense (break-even time).
+   TN_TickCnt min_residency;
+   ///
+   /// Relative power consumption in the state: among the states which fit
+   /// the time until the next deadline, the one with the least power is
+   /// chosen.
+   unsigned int power;
+   ///
+   /// Whether the tick counter (see `#TN_CBTickCntGet`) stops in this state.
+   /// If so, the kernel adds the time returned by `enter` to the system
+   /// tick count on wake-up.
+   TN_BOOL tick_stopped;
+   ///
+   /// Function which puts MCU into this state, see `#TN_CBSleepEnter`.
+   TN_CBSleepEnter *enter;
+   ///
+   /// Statistics managed by the kernel: how many times the state was
+   /// entered.
+   unsigned long entries_cnt;
+   ///
+   /// Statistics managed by the kernel: total time spent in the state,
+   /// in system ticks.
+   TN_TickCnt residency;
+};
+#endif
+
+#if TN_HYBRID_TICK || DOXYGEN_ACTIVE
+/**
+ * Prototype of the function which suppresses the periodic tick while the
+ * system is idle, see `tn_callback_tick_suppress_set()`.
+ *
+ * It is called from the idle task with interrupts disabled. It should stop
+ * the periodic tick interrupt, program the wake-up after `max_ticks` ticks
+ * (unless it is `#TN_WAIT_INFINITE`), and put the MCU into the sleep state
+ * in such a way that any pending interrupt wakes it up (say, on Cortex-M,
+ * `WFI` wakes up even if interrupts are disabled by `PRIMASK`). After
+ * wake-up, it should restart the periodic tick in phase with the skipped
+ * ones, and return.
+ *
+ * @param max_ticks
+ *    Maximum number of ticks to skip: the tick at which the nearest timer
+ *    expires is always handled by `tn_tick_int_processing()` as usual. It
+ *    is `#TN_WAIT_INFINITE` if there are no active timeouts at all.
+ *
+ * @return
+ *    Number of whole ticks elapsed while the tick interrupt was stopped, not
+ *    more than `max_ticks`. The kernel adds them to the system tick count
+ *    at once.
+ */
+typedef TN_TickCnt (TN_CBTickSuppress)(TN_TickCnt max_ticks);
+#endif
+
+#if TN_TIME_PARTITIONS || DOXYGEN_ACTIVE
+/**
+ * Time window of the major frame, see `tn_sys_time_windows_set()`.
+ *
+ * Available if only `#TN_TIME_PARTITIONS` option is non-zero.
+ */
+struct TN_TimeWindow {
+   ///
+   /// Bitmask of task priorities which are eligible to run during this
+   /// window: bit `(1 << priority)` for each priority.
+   unsigned int prio_mask;
+   ///
+   /// Duration of the window in system ticks, can't be `0` or more than
+   /// `(#TN_WAIT_INFINITE / 2)`.
+   TN_TickCnt duration;
+};
+#endif
+
 
 
 
@@ -455,6 +647,128 @@ void tn_tick_int_processing(void);
  */
 enum TN_RCode tn_sys_tslice_set(int priority, int ticks);
 
+#if TN_IDLE_GOVERNOR || DOXYGEN_ACTIVE
+/**
+ * Set sleep states for the idle governor (see `#TN_IDLE_GOVERNOR`). If
+ * states are set, then each time after the idle callback (given to
+ * `tn_sys_start()`) returns, the idle task checks the time until the next
+ * kernel deadline (see `tn_sys_next_deadline_get()`), and enters the state
+ * with the least `power` among the states for which `latency +
+ * min_residency` fits that time. If no state fits, the idle task just goes
+ * on.
+ *
+ * Statistics fields of the states (`entries_cnt` and `residency`) are reset.
+ *
+ * Available if only `#TN_IDLE_GOVERNOR` option is non-zero.
+ *
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param states
+ *    Array of states. The kernel doesn't copy it, and updates statistics
+ *    in it, so it should be valid while the governor uses it.
+ * @param states_cnt
+ *    Number of states in the array. If `0`, the governor is turned off.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if given states are invalid.
+ */
+enum TN_RCode tn_sys_sleep_states_set(
+      struct TN_SleepState *states,
+      int states_cnt
+      );
+#endif
+
+#if TN_IDLE_GOVERNOR || TN_HYBRID_TICK || DOXYGEN_ACTIVE
+/**
+ * Get time until the next kernel deadline (the nearest active timer or
+ * task timeout), in system ticks. Useful for custom idle callbacks.
+ *
+ * Available if only `#TN_IDLE_GOVERNOR` or `#TN_HYBRID_TICK` option is
+ * non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @return
+ *    Time until the next deadline; `0` if it is already reached;
+ *    `#TN_WAIT_INFINITE` if there are no active timeouts.
+ */
+TN_TickCnt tn_sys_next_deadline_get(void);
+#endif
+
+#if TN_HYBRID_TICK || DOXYGEN_ACTIVE
+/**
+ * Set the callback which suppresses the periodic tick while the system is
+ * idle (see `#TN_HYBRID_TICK`). If it is set, then each time after the idle
+ * callback (given to `tn_sys_start()`) returns, the idle task checks the
+ * time until the nearest timer expiration, and if it is more than one tick,
+ * it calls `cb_tick_suppress`, and then adds the skipped ticks to the system
+ * tick count in one step. While some task is runnable, the tick is periodic
+ * as usual.
+ *
+ * Available if only `#TN_HYBRID_TICK` option is non-zero.
+ *
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param cb_tick_suppress
+ *    Callback function, see `#TN_CBTickSuppress`. If `TN_NULL`, the tick
+ *    is never suppressed.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context.
+ */
+enum TN_RCode tn_callback_tick_suppress_set(
+      TN_CBTickSuppress *cb_tick_suppress
+      );
+#endif
+
+#if TN_TIME_PARTITIONS || DOXYGEN_ACTIVE
+/**
+ * Set time partitioning schedule (see `#TN_TIME_PARTITIONS`): major frame
+ * consisting of `windows_cnt` time windows, which are activated one after
+ * another, cyclically. The first window is activated immediately.
+ *
+ * While some window is active, only tasks with priorities from its
+ * `prio_mask` or from `always_prio_mask` are eligible to run; tasks of other
+ * priorities stay runnable, but they don't get CPU until their window comes.
+ * The idle task is always eligible.
+ *
+ * Available if only `#TN_TIME_PARTITIONS` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param windows
+ *    Array of windows. The kernel doesn't copy it, so it should be valid
+ *    while the schedule is active (typically, it is a `const` array).
+ * @param windows_cnt
+ *    Number of windows in the array. If `0`, time partitioning is turned
+ *    off, and all tasks are eligible again.
+ * @param always_prio_mask
+ *    Bitmask of priorities which are eligible in every window: bit
+ *    `(1 << priority)` for each priority.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if given windows are invalid.
+ */
+enum TN_RCode tn_sys_time_windows_set(
+      const struct TN_TimeWindow *windows,
+      int windows_cnt,
+      unsigned int always_prio_mask
+      );
+#endif
+
 /**
  * Get current system ticks count.
  *
@@ -487,6 +801,26 @@ TN_TickCnt tn_sys_time_get(void);
  */
 void tn_callback_deadlock_set(TN_CBDeadlock *cb);
 
+#if TN_MUTEX_CEIL_LEARN || DOXYGEN_ACTIVE
+/**
+ * Set callback function that should be called whenever some task violates
+ * the mutex priority ceiling.
+ *
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * **Note:** this function should be called from `main()`, before
+ * `tn_sys_start()`.
+ *
+ * @param cb
+ *    Pointer to user-provided callback function.
+ *
+ * @see `#TN_MUTEX_CEIL_LEARN`
+ * @see `#TN_CBMutexCeilViolation` for callback function prototype
+ */
+void tn_callback_mutex_ceil_violation_set(TN_CBMutexCeilViolation *cb);
+#endif
+
 /**
  * Set callback function that is called when the kernel detects stack overflow
  * (see `#TN_STACK_OVERFLOW_CHECK`).
@@ -45,6 +45,8 @@
 //-- internal tnkernel headers
 #include "_tn_tasks.h"
 #include "_tn_mutex.h"
+#include "_tn_ratelimit.h"
+#include "_tn_isrrec.h"
 #include "_tn_timer.h"
 #include "_tn_list.h"
 
@@ -66,6 +68,43 @@
 
 
 
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#if TN_STACK_FILL_LAZY
+///
+/// Count of tasks whose stacks aren't completely filled with
+/// `#TN_FILL_STACK_VAL` yet, see `#TN_STACK_FILL_LAZY`.
+static volatile int _stack_fill_pending_cnt = 0;
+#endif
+
+#if TN_TASK_RELEASE_TABLE
+///
+/// Time-triggered release table, see `tn_task_release_table_set()`.
+static const struct TN_TaskRelease *_release_table = TN_NULL;
+///
+/// Number of entries in `_release_table`; 0 if release table is off.
+static int _release_entries_cnt = 0;
+///
+/// Index of the first entry which is going to be released next.
+static int _release_entry_next = 0;
+///
+/// Length of the hyperperiod.
+static TN_TickCnt _release_hyperperiod;
+///
+/// System tick count at which the current hyperperiod has started.
+static TN_TickCnt _release_hyperperiod_start;
+///
+/// User-provided overrun callback, may be `TN_NULL`.
+static TN_CBTaskOverrun *_release_cb_overrun = TN_NULL;
+///
+/// Timer which releases tasks.
+static struct TN_Timer _release_timer;
+#endif
+
+
+
 /*******************************************************************************
  *    PRIVATE FUNCTIONS
  ******************************************************************************/
@@ -87,8 +126,42 @@ _TN_STATIC_INLINE enum TN_RCode _check_param_generic(
    return rc;
 }
 
+#if TN_TASK_GROUPS
+_TN_STATIC_INLINE enum TN_RCode _check_param_group(
+      const struct TN_TaskGroup *group
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (group == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (group->id_task_group != TN_ID_TASK_GROUP){
+      rc = TN_RC_INVALID_OBJ;
+   }
+
+   return rc;
+}
+
+_TN_STATIC_INLINE enum TN_RCode _check_param_group_create(
+      const struct TN_TaskGroup *group
+      )
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (group == TN_NULL){
+      rc = TN_RC_WPARAM;
+   } else if (group->id_task_group == TN_ID_TASK_GROUP){
+      rc = TN_RC_WPARAM;
+   }
+
+   return rc;
+}
+#endif
+
 #else
 #  define _check_param_generic(task)            (TN_RC_OK)
+#  define _check_param_group(group)             (TN_RC_OK)
+#  define _check_param_group_create(group)      (TN_RC_OK)
 #endif
 // }}}
 
@@ -105,6 +178,9 @@ _TN_STATIC_INLINE void _init_mutex_queue(struct TN_Task *task)
 _TN_STATIC_INLINE void _init_deadlock_list(struct TN_Task *task)
 {
    _tn_list_reset(&(task->deadlock_list));
+#if TN_MUTEX_DEADLOCK_DETECT_DEFER
+   _tn_list_reset(&(task->deadlock_check_queue));
+#endif
 }
 #else
 #  define   _init_deadlock_list(task)
@@ -115,6 +191,142 @@ _TN_STATIC_INLINE void _init_deadlock_list(struct TN_Task *task)
 #  define   _init_deadlock_list(task)
 #endif
 
+/**
+ * Fill the stack region `[p_start, p_end)` with `#TN_FILL_STACK_VAL`.
+ */
+_TN_STATIC_INLINE void _stack_fill(TN_UWord *p_start, TN_UWord *p_end)
+{
+   while (p_start < p_end){
+      *p_start++ = TN_FILL_STACK_VAL;
+   }
+}
+
+#if TN_STACK_FILL_LAZY
+
+#if (_TN_ARCH_STACK_DIR == _TN_ARCH_STACK_DIR__ASC)
+//-- full ascending stack: stack end is at the highest address {{{
+
+/**
+ * Fill the guard region at the end of the stack, and return value for the
+ * `stack_fill_pt` field of the task: the lowest already filled address, or
+ * `#TN_NULL` if the whole stack was filled.
+ */
+static TN_UWord *_stack_fill_guard(
+      TN_UWord *stack_low_addr,
+      int stack_size
+      )
+{
+   TN_UWord *ret = TN_NULL;
+
+   if (stack_size <= TN_STACK_FILL_GUARD_SIZE){
+      _stack_fill(stack_low_addr, stack_low_addr + stack_size);
+   } else {
+      ret = stack_low_addr + stack_size - TN_STACK_FILL_GUARD_SIZE;
+      _stack_fill(ret, stack_low_addr + stack_size);
+   }
+
+   return ret;
+}
+
+/**
+ * Fill next chunk of the stack of the given task, moving towards the stack
+ * origin, but not touching the part of stack which is used currently.
+ *
+ * Interrupts should be disabled, and the task should not be running.
+ *
+ * @return `TN_TRUE` if there's nothing more to fill.
+ */
+static TN_BOOL _stack_fill_chunk(struct TN_Task *task)
+{
+   TN_UWord *p_limit;
+   TN_UWord *p_start;
+
+   if (_tn_task_is_dormant(task)){
+      //-- stack isn't used at all
+      p_limit = task->stack_low_addr;
+   } else {
+      //-- words up to the saved stack pointer (including it) are used
+      p_limit = task->stack_cur_pt + 1;
+   }
+
+   if (task->stack_fill_pt - p_limit > TN_STACK_FILL_GUARD_SIZE){
+      p_start = task->stack_fill_pt - TN_STACK_FILL_GUARD_SIZE;
+   } else {
+      p_start = p_limit;
+   }
+
+   _stack_fill(p_start, task->stack_fill_pt);
+   task->stack_fill_pt = (p_start <= p_limit) ? TN_NULL : p_start;
+
+   return (task->stack_fill_pt == TN_NULL);
+}
+
+// }}}
+#elif (_TN_ARCH_STACK_DIR == _TN_ARCH_STACK_DIR__DESC)
+//-- full descending stack: stack end is at the lowest address {{{
+
+/**
+ * Fill the guard region at the end of the stack, and return value for the
+ * `stack_fill_pt` field of the task: the address right after the filled
+ * region, or `#TN_NULL` if the whole stack was filled.
+ */
+static TN_UWord *_stack_fill_guard(
+      TN_UWord *stack_low_addr,
+      int stack_size
+      )
+{
+   TN_UWord *ret = TN_NULL;
+
+   if (stack_size <= TN_STACK_FILL_GUARD_SIZE){
+      _stack_fill(stack_low_addr, stack_low_addr + stack_size);
+   } else {
+      ret = stack_low_addr + TN_STACK_FILL_GUARD_SIZE;
+      _stack_fill(stack_low_addr, ret);
+   }
+
+   return ret;
+}
+
+/**
+ * Fill next chunk of the stack of the given task, moving towards the stack
+ * origin, but not touching the part of stack which is used currently.
+ *
+ * Interrupts should be disabled, and the task should not be running.
+ *
+ * @return `TN_TRUE` if there's nothing more to fill.
+ */
+static TN_BOOL _stack_fill_chunk(struct TN_Task *task)
+{
+   TN_UWord *p_limit;
+   TN_UWord *p_end;
+
+   if (_tn_task_is_dormant(task)){
+      //-- stack isn't used at all
+      p_limit = task->stack_high_addr + 1;
+   } else {
+      //-- words from the saved stack pointer (including it) are used
+      p_limit = task->stack_cur_pt;
+   }
+
+   if (p_limit - task->stack_fill_pt > TN_STACK_FILL_GUARD_SIZE){
+      p_end = task->stack_fill_pt + TN_STACK_FILL_GUARD_SIZE;
+   } else {
+      p_end = p_limit;
+   }
+
+   _stack_fill(task->stack_fill_pt, p_end);
+   task->stack_fill_pt = (p_end >= p_limit) ? TN_NULL : p_end;
+
+   return (task->stack_fill_pt == TN_NULL);
+}
+
+// }}}
+#else
+#  error wrong _TN_ARCH_STACK_DIR
+#endif
+
+#endif // TN_STACK_FILL_LAZY
+
 
 /**
  * Looks for first runnable task with highest priority,
@@ -126,10 +338,23 @@ static void _find_next_task_to_run(void)
 {
    int priority;
 
+#if TN_LAZY_SCHED
+   //-- the decision is going to be up to date
+   _tn_next_task_dirty = TN_FALSE;
+#endif
+
+#if TN_TIME_PARTITIONS
+   //-- only priorities eligible in the current time window are considered
+   //   (idle task priority is always eligible)
+   unsigned int ready_bmp = _tn_ready_to_run_bmp & _tn_ready_to_run_mask;
+#else
+   unsigned int ready_bmp = _tn_ready_to_run_bmp;
+#endif
+
 #ifdef _TN_FFS
    //-- architecture-dependent way to find-first-set-bit is available,
    //   so use it.
-   priority = _TN_FFS(_tn_ready_to_run_bmp);
+   priority = _TN_FFS(ready_bmp);
    priority--;
 #else
    //-- there is no architecture-dependent way to find-first-set-bit available,
@@ -142,7 +367,7 @@ static void _find_next_task_to_run(void)
 
    for (i = 0; i < TN_PRIORITIES_CNT; i++){
       //-- for each bit in bmp
-      if (_tn_ready_to_run_bmp & mask){
+      if (ready_bmp & mask){
          priority = i;
          break;
       }
@@ -200,6 +425,62 @@ _TN_STATIC_INLINE enum TN_RCode _task_release_wait(struct TN_Task *task)
    return rc;
 }
 
+/**
+ * See the comment for tn_task_suspend in the tn_tasks.h
+ */
+_TN_STATIC_INLINE enum TN_RCode _task_suspend(struct TN_Task *task)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (_tn_task_is_suspended(task) || _tn_task_is_dormant(task)){
+      //-- task is already suspended, or it is dormant;
+      //   in either case, the state is wrong for suspending.
+      rc = TN_RC_WSTATE;
+   } else {
+
+      //-- if task is runnable, clear runnable state.
+      //   Note: it might be waiting instead of runnable: then,
+      //   don't do anything with 'waiting' state: it is legal
+      //   for task to be in waiting + suspended state.
+      //   (TN_TASK_STATE_WAITSUSP)
+      if (_tn_task_is_runnable(task)){
+         _tn_task_clear_runnable(task);
+      }
+
+      //-- set suspended state
+      _tn_task_set_suspended(task);
+
+   }
+
+   return rc;
+}
+
+/**
+ * See the comment for tn_task_resume in the tn_tasks.h
+ */
+_TN_STATIC_INLINE enum TN_RCode _task_resume(struct TN_Task *task)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (!_tn_task_is_suspended(task)){
+      //-- task isn't suspended; this is wrong state.
+      rc = TN_RC_WSTATE;
+   } else {
+
+      //-- clear suspended state
+      _tn_task_clear_suspended(task);
+
+      if (!_tn_task_is_waiting(task)){
+         //-- The task is not in the WAIT-SUSPEND state,
+         //   so we need to make it runnable and probably switch context
+         _tn_task_set_runnable(task);
+      }
+
+   }
+
+   return rc;
+}
+
 _TN_STATIC_INLINE enum TN_RCode _task_delete(struct TN_Task *task)
 {
    enum TN_RCode rc = TN_RC_OK;
@@ -211,6 +492,21 @@ _TN_STATIC_INLINE enum TN_RCode _task_delete(struct TN_Task *task)
       _tn_list_remove_entry(&(task->create_queue));
       _tn_tasks_created_cnt--;
       task->id_task = TN_ID_NONE;
+
+#if TN_TASK_GROUPS
+      if (task->group != TN_NULL){
+         _tn_list_remove_entry(&(task->group_queue));
+         task->group = TN_NULL;
+      }
+#endif
+
+#if TN_STACK_FILL_LAZY
+      if (task->stack_fill_pt != TN_NULL){
+         //-- stack of deleted task will never be filled
+         task->stack_fill_pt = TN_NULL;
+         _stack_fill_pending_cnt--;
+      }
+#endif
    }
 
    return rc;
@@ -292,16 +588,154 @@ _TN_STATIC_INLINE TN_BOOL _remove_entry_from_ready_queue(
    return ret;
 }
 
+#if TN_FAIR_SHARE
+/**
+ * Compare virtual run times with wrap-around in mind.
+ *
+ * @return `TN_TRUE` if `a` is later than `b`.
+ */
+_TN_STATIC_INLINE TN_BOOL _fs_vruntime_after(unsigned long a, unsigned long b)
+{
+   return ((long)(a - b) > 0);
+}
+
+/**
+ * Insert task into the ready queue `pri_queue` ordered by virtual run time:
+ * starting from `list_item`, find the first task with later virtual run time,
+ * and put the task before it.
+ */
+static void _fs_insert(
+      struct TN_Task *task,
+      struct TN_ListItem *pri_queue,
+      struct TN_ListItem *list_item
+      )
+{
+   while (
+         list_item != pri_queue
+         && !_fs_vruntime_after(
+            _tn_get_task_by_tsk_queue(list_item)->fs_vruntime,
+            task->fs_vruntime
+            )
+         )
+   {
+      list_item = list_item->next;
+   }
+
+   //-- and put the task before it
+   _tn_list_add_tail(list_item, &(task->task_queue));
+}
+#endif
+
 _TN_STATIC_INLINE void _add_entry_to_ready_queue(
       struct TN_ListItem *list_node, int priority
       )
 {
+#if TN_FAIR_SHARE
+   struct TN_ListItem *pri_queue = &(_tn_tasks_ready_list[priority]);
+
+   if (_tn_tslice_ticks[priority] != TN_NO_TIME_SLICE){
+      struct TN_Task *task = _tn_get_task_by_tsk_queue(list_node);
+
+      if (!_tn_list_is_empty(pri_queue)){
+         //-- don't let the task catch up for the time it was not runnable:
+         //   its virtual run time should be at least that of the queue head
+         unsigned long head_vruntime
+            = _tn_get_task_by_tsk_queue(pri_queue->next)->fs_vruntime;
+
+         if (_fs_vruntime_after(head_vruntime, task->fs_vruntime)){
+            task->fs_vruntime = head_vruntime;
+         }
+      }
+
+      //-- the running task should stay at the head of the queue until its
+      //   time slice is over, so the head is skipped if it is the running one
+      struct TN_ListItem *list_item = pri_queue->next;
+      if (
+            list_item != pri_queue
+            && _tn_get_task_by_tsk_queue(list_item) == _tn_curr_run_task
+         )
+      {
+         list_item = list_item->next;
+      }
+
+      _fs_insert(task, pri_queue, list_item);
+   } else {
+      _tn_list_add_tail(pri_queue, list_node);
+   }
+#else
    _tn_list_add_tail(&(_tn_tasks_ready_list[priority]), list_node);
+#endif
    _tn_ready_to_run_bmp |= (1 << priority);
 }
 
 // }}}
 
+//-- Time-triggered release {{{
+#if TN_TASK_RELEASE_TABLE
+
+/**
+ * Callback of `_release_timer`: release all tasks scheduled for the current
+ * offset, and restart the timer for the next offset. It is called from the
+ * $(TN_SYS_TIMER_LINK) interrupt, which pends context switch (if needed)
+ * after all timers are handled, so all the releases lead to a single
+ * scheduling decision.
+ */
+static void _release_timer_func(struct TN_Timer *timer, void *p_user_data)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   _TN_UNUSED(p_user_data);
+
+   //-- release table might be turned off while the callback was pending
+   if (_release_entries_cnt > 0){
+      TN_TickCnt offset = _release_table[_release_entry_next].offset;
+
+      //-- release all the tasks with the current offset
+      do {
+         struct TN_Task *task = _release_table[_release_entry_next].task;
+
+         if (_tn_task_is_dormant(task)){
+            _tn_task_activate(task);
+         } else if (
+               _tn_task_is_waiting(task)
+               && task->task_wait_reason == TN_WAIT_REASON_SLEEP
+               )
+         {
+            _tn_task_wait_complete(task, TN_RC_OK);
+         } else if (_release_cb_overrun != TN_NULL){
+            //-- task isn't done with its previous job yet
+            _release_cb_overrun(task);
+         }
+
+         _release_entry_next++;
+      } while (
+            _release_entry_next < _release_entries_cnt
+            && _release_table[_release_entry_next].offset == offset
+            );
+
+      if (_release_entry_next >= _release_entries_cnt){
+         //-- go to the next hyperperiod
+         _release_entry_next = 0;
+         _release_hyperperiod_start += _release_hyperperiod;
+      }
+
+      //-- the next release tick is calculated from the start of the
+      //   hyperperiod, not from the current time: with dynamic tick, the
+      //   callback might be called some time after the expiration tick,
+      //   and this delay shouldn't shift the following releases.
+      _tn_timer_start_at(
+            timer,
+            _release_hyperperiod_start
+            + _release_table[_release_entry_next].offset
+            );
+   }
+
+   tn_arch_sr_restore(sr_saved);
+}
+
+#endif // TN_TASK_RELEASE_TABLE
+// }}}
+
 /**
  * handle current wait_reason: say, for MUTEX_I, we should
  * handle priorities of other involved tasks.
@@ -339,6 +773,13 @@ static void _on_task_wait_complete(struct TN_Task *task)
       _tn_mutex_on_task_wait_complete(task);
    }
 
+#if TN_RATE_LIMITER
+   //-- for rate limiter, call special handler
+   if (task->task_wait_reason == TN_WAIT_REASON_RATELIMIT){
+      _tn_ratelimit_on_task_wait_complete(task);
+   }
+#endif
+
 }
 
 /**
@@ -348,8 +789,11 @@ static void _on_task_wait_complete(struct TN_Task *task)
  *    * unlock all mutexes that are held by task
  *    * set dormant state (reinitialize everything)
  *    * reitinialize stack
+ *
+ * `TN_INTSAVE_VAR` is the status register value saved by the caller when it
+ * disabled interrupts, see `_tn_sys_preempt_point()`.
  */
-static void _task_terminate(struct TN_Task *task)
+static void _task_terminate(struct TN_Task *task, TN_UWord TN_INTSAVE_VAR)
 {
 #if TN_DEBUG
    if (task->task_state != TN_TASK_STATE_NONE){
@@ -358,7 +802,13 @@ static void _task_terminate(struct TN_Task *task)
 #endif
 
    //-- Unlock all mutexes locked by the task
-   _tn_mutex_unlock_all_by_task(task);
+   _tn_mutex_unlock_all_by_task(task, TN_INTSAVE_VAR);
+
+#if TN_LAZY_TIMEOUT
+   //-- the timer might be still running (stale) after the last wait, 
+   //   and task might be deleted after it's terminated: cancel the timer
+   _tn_timer_cancel(&task->timer);
+#endif
 
    //-- task is already in the state NONE, so, we just need 
    //   to set dormant state.
@@ -390,11 +840,28 @@ static void _task_wait_timeout(struct TN_Timer *timer, void *p_user_data)
    TN_INTSAVE_DATA_INT;
    TN_INT_IDIS_SAVE();
 
-   _tn_task_wait_complete(task, TN_RC_TIMEOUT);
+#if TN_LAZY_TIMEOUT
+   if (!task->timeout_armed){
+      //-- the timer is stale: the wait is already completed,
+      //   so, nothing to do here
+   } else {
+      TN_TickCnt time_left = task->timeout_deadline - _tn_timer_sys_time_get();
 
-   TN_INT_IRESTORE();
+      if (time_left != 0 && time_left <= (TN_WAIT_INFINITE >> 1)){
+         //-- stale timer was reused for the later deadline:
+         //   restart it for the rest of the timeout
+         _tn_timer_start(timer, time_left);
+      } else {
+         _tn_task_wait_complete(task, TN_RC_TIMEOUT);
+      }
+   }
+#else
+   _tn_task_wait_complete(task, TN_RC_TIMEOUT);
 
    _TN_UNUSED(timer);
+#endif
+
+   TN_INT_IRESTORE();
 }
 
 /*******************************************************************************
@@ -418,7 +885,9 @@ enum TN_RCode tn_task_create(
    enum TN_RCode rc;
    enum TN_Context context;
 
-   int i;
+#if TN_STACK_FILL_LAZY
+   TN_UWord *stack_fill_pt = TN_NULL;
+#endif
 
    //-- Lightweight checking of system tasks recreation
    if (     priority == (TN_PRIORITIES_CNT - 1)
@@ -451,6 +920,20 @@ enum TN_RCode tn_task_create(
       return TN_RC_WCONTEXT;
    }
 
+   //-- fill task stack space by #TN_FILL_STACK_VAL. It is done before
+   //   interrupts are disabled: nobody else accesses the stack of the task
+   //   which isn't created yet.
+#if TN_STACK_FILL_LAZY
+   if (!(opts & _TN_TASK_CREATE_OPT_IDLE)){
+      //-- fill just the guard region at the end of the stack; the rest will
+      //   be filled by the idle task.
+      stack_fill_pt = _stack_fill_guard(task_stack_low_addr, task_stack_size);
+   } else
+#endif
+   {
+      _stack_fill(task_stack_low_addr, task_stack_low_addr + task_stack_size);
+   }
+
    if (context == TN_CONTEXT_TASK){
       TN_INT_DIS_SAVE();
    }
@@ -462,6 +945,13 @@ enum TN_RCode tn_task_create(
    task->stack_low_addr = task_stack_low_addr;
    task->stack_high_addr = task_stack_low_addr + task_stack_size - 1;
 
+#if TN_STACK_FILL_LAZY
+   task->stack_fill_pt = stack_fill_pt;
+   if (stack_fill_pt != TN_NULL){
+      _stack_fill_pending_cnt++;
+   }
+#endif
+
    task->base_priority   = priority;
    task->task_state      = TN_TASK_STATE_NONE;
    task->id_task         = TN_ID_TASK;
@@ -475,18 +965,9 @@ enum TN_RCode tn_task_create(
    memset(&task->profiler, 0x00, sizeof(task->profiler));
 #endif
 
-   //-- fill all task stack space by #TN_FILL_STACK_VAL
-   {
-      TN_UWord *ptr_stack;
-      for (
-            i = 0, ptr_stack = task_stack_low_addr;
-            i < task_stack_size;
-            i++ 
-          )
-      {
-         *ptr_stack++ = TN_FILL_STACK_VAL;
-      }
-   }
+#if TN_FAIR_SHARE
+   task->fs_vruntime_inc = TN_FAIR_SHARE_VRUNTIME_SCALE / TN_FAIR_SHARE_WEIGHT_DEF;
+#endif
 
    //-- reset task_queue (the queue used to include task to runqueue or 
    //   waitqueue)
@@ -494,6 +975,9 @@ enum TN_RCode tn_task_create(
 
    //-- init timer that is needed to implement task wait timeout
    _tn_timer_create(&task->timer, _task_wait_timeout, task);
+#if TN_LAZY_TIMEOUT
+   task->timeout_armed = 0;
+#endif
 
    //-- init auxiliary lists needed for tasks
    _init_mutex_queue(task);
@@ -506,6 +990,12 @@ enum TN_RCode tn_task_create(
    _tn_list_add_tail(&_tn_tasks_created_list, &(task->create_queue));
    _tn_tasks_created_cnt++;
 
+#if TN_TASK_GROUPS
+   //-- task doesn't belong to any group initially
+   _tn_list_reset(&(task->group_queue));
+   task->group = TN_NULL;
+#endif
+
    if ((opts & TN_TASK_CREATE_OPT_START)){
       _tn_task_activate(task);
    }
@@ -552,10 +1042,26 @@ enum TN_RCode tn_task_create_wname(
  */
 enum TN_RCode tn_task_suspend(struct TN_Task *task)
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   return _task_job_perform(task, _task_suspend);
+}
 
-   if (rc != TN_RC_OK){
-      //-- just return rc as it is
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_resume(struct TN_Task *task)
+{
+   return _task_job_perform(task, _task_resume);
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_sleep(TN_TickCnt timeout)
+{
+   enum TN_RCode rc;
+
+   if (timeout == 0){
+      rc = TN_RC_TIMEOUT;
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
@@ -563,40 +1069,179 @@ enum TN_RCode tn_task_suspend(struct TN_Task *task)
 
       TN_INT_DIS_SAVE();
 
-      if (_tn_task_is_suspended(task) || _tn_task_is_dormant(task)){
-         //-- task is already suspended, or it is dormant;
-         //   in either case, the state is wrong for suspending.
-         rc = TN_RC_WSTATE;
-      } else {
+      //-- put task to wait with reason SLEEP and without wait queue.
+      _tn_task_curr_to_wait_action(TN_NULL, TN_WAIT_REASON_SLEEP, timeout);
 
-         //-- if task is runnable, clear runnable state.
-         //   Note: it might be waiting instead of runnable: then,
-         //   don't do anything with 'waiting' state: it is legal
-         //   for task to be in waiting + suspended state.
-         //   (TN_TASK_STATE_WAITSUSP)
-         if (_tn_task_is_runnable(task)){
-            _tn_task_clear_runnable(task);
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+      rc = _tn_curr_run_task->task_wait_rc;
+
+   }
+
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_yield(void)
+{
+   enum TN_RCode rc = TN_RC_OK;
+
+   if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      struct TN_Task *task = _tn_curr_run_task;
+      struct TN_ListItem *pri_queue = &(_tn_tasks_ready_list[task->priority]);
+
+      //-- if there are more than 1 task in the ready queue for the current
+      //   priority, move current task to the tail of it
+      if (pri_queue->next->next != pri_queue){
+#if TN_FAIR_SHARE
+         if (_tn_tslice_ticks[task->priority] != TN_NO_TIME_SLICE){
+            _tn_task_fair_share_requeue(task);
+         } else {
+            _tn_list_remove_entry(&(task->task_queue));
+            _tn_list_add_tail(pri_queue, &(task->task_queue));
+         }
+#else
+         _tn_list_remove_entry(&(task->task_queue));
+         _tn_list_add_tail(pri_queue, &(task->task_queue));
+#endif
+
+         if (_tn_next_task_to_run == task){
+            _tn_next_task_to_run = _tn_get_task_by_tsk_queue(pri_queue->next);
          }
+      }
 
-         //-- set suspended state
-         _tn_task_set_suspended(task);
+      task->tslice_count = 0;
 
+      _tn_next_task_resolve();
+
+      //-- current task is still runnable, so `_tn_need_context_switch()`
+      //   would return false in cooperative mode: pend the switch explicitly.
+      if (_tn_curr_run_task != _tn_next_task_to_run){
+         _tn_arch_context_switch_pend();
       }
 
       TN_INT_RESTORE();
-      _tn_context_switch_pend_if_needed();
-
    }
+
    return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_resume(struct TN_Task *task)
+enum TN_RCode tn_task_wakeup(struct TN_Task *task)
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   return _task_job_perform(task, _task_wakeup);
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_iwakeup(struct TN_Task *task)
+{
+   enum TN_RCode rc = _task_job_iperform(task, _task_wakeup);
+
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_TASK_IWAKEUP, task, 0, 0, rc);
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_activate(struct TN_Task *task)
+{
+   return _task_job_perform(task, _tn_task_activate);
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_iactivate(struct TN_Task *task)
+{
+   enum TN_RCode rc = _task_job_iperform(task, _tn_task_activate);
+
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_TASK_IACTIVATE, task, 0, 0, rc);
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_release_wait(struct TN_Task *task)
+{
+   return _task_job_perform(task, _task_release_wait);
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_irelease_wait(struct TN_Task *task)
+{
+   enum TN_RCode rc = _task_job_iperform(task, _task_release_wait);
 
+   _TN_ISRREC_PUT(TN_ISRREC_CALL_TASK_IRELEASE_WAIT, task, 0, 0, rc);
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+void tn_task_exit(enum TN_TaskExitOpt opts)
+{
+   struct TN_Task *task;
+	 
+   if (!tn_is_task_context()){
+      //-- do nothing, just return
+   } else {
+      TN_INTSAVE_DATA;
+
+      //-- here, we unconditionally disable interrupts:
+      //   this function never returns, and interrupt status is restored
+      //   from different task's stack inside 
+      //   `_tn_arch_context_switch_now_nosave()` call.
+      //
+      //   The saved status is only needed for preemption points in
+      //   `_task_terminate()`.
+      TN_INT_DIS_SAVE();
+
+      task = _tn_curr_run_task;
+
+      //-- clear runnable state of currently running task,
+      //   and terminate it
+
+      _tn_task_clear_runnable(task);
+      _task_terminate(task, TN_INTSAVE_VAR);
+
+      if ((opts & TN_TASK_EXIT_OPT_DELETE)){
+         //-- after exiting from task, we should delete it as well
+         //   (because appropriate flag was set)
+         _task_delete(task);
+      }
+
+      _tn_next_task_resolve();
+
+      //-- interrupts will be enabled inside _tn_arch_context_switch_now_nosave()
+      _tn_arch_context_switch_now_nosave();  
+   }
+
+   return;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_terminate(struct TN_Task *task)
+{
+   enum TN_RCode rc = _check_param_generic(task);
+	 
    if (rc != TN_RC_OK){
       //-- just return rc as it is
    } else if (!tn_is_task_context()){
@@ -606,39 +1251,232 @@ enum TN_RCode tn_task_resume(struct TN_Task *task)
 
       TN_INT_DIS_SAVE();
 
-      if (!_tn_task_is_suspended(task)){
-         //-- task isn't suspended; this is wrong state.
+      if (_tn_task_is_dormant(task)){
+         //-- The task is already terminated
          rc = TN_RC_WSTATE;
+      } else if (_tn_curr_run_task == task){
+         //-- Cannot terminate currently running task
+         //   (use tn_task_exit() instead)
+         rc = TN_RC_WCONTEXT;
       } else {
 
-         //-- clear suspended state
-         _tn_task_clear_suspended(task);
+         if (_tn_task_is_runnable(task)){
+            //-- if task is runnable, we must clear runnable state
+            //   before terminating the task
+            _tn_task_clear_runnable(task);
+         } else if (_tn_task_is_waiting(task)){
+            //-- if task is waiting, we must clear waiting state
+            //   before terminating the task.
+            //   No matter what waiting result code we specify:
+            //   nobody is going to read it.
+            _tn_task_clear_waiting(
+                  task,
+                  TN_RC_OK    //-- doesn't matter: nobody will read it
+                  );
+         }
 
-         if (!_tn_task_is_waiting(task)){
-            //-- The task is not in the WAIT-SUSPEND state,
-            //   so we need to make it runnable and probably switch context
-            _tn_task_set_runnable(task);
+         if (_tn_task_is_suspended(task)){
+            //-- if task is suspended, we must clear suspended state
+            //   before terminating the task
+            _tn_task_clear_suspended(task);
          }
 
+         //-- eventually, terminate the task
+         _task_terminate(task, TN_INTSAVE_VAR);
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
+
+   }
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_delete(struct TN_Task *task)
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+      rc = _task_delete(task);
+      TN_INT_RESTORE();
+
+   }
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_state_get(
+      struct TN_Task *task,
+      enum TN_TaskState *p_state
+      )
+{
+   enum TN_RCode rc = _check_param_generic(task);
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+      *p_state = task->task_state;
+      TN_INT_RESTORE();
+   }
+   return rc;
+}
+
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_change_priority(struct TN_Task *task, int new_priority)
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (new_priority < 0 || new_priority >= (TN_PRIORITIES_CNT - 1)){
+      rc = TN_RC_WPARAM;
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
+   } else {
+      TN_INTSAVE_DATA;
+
+      TN_INT_DIS_SAVE();
+
+      if (new_priority == 0){
+         new_priority = task->base_priority;
+      }
+
+      rc = TN_RC_OK;
+
+      if (_tn_task_is_dormant(task)){
+         rc = TN_RC_WSTATE;
+      } else {
+         _tn_change_task_priority(task, new_priority);
       }
 
       TN_INT_RESTORE();
       _tn_context_switch_pend_if_needed();
+   }
+   return rc;
+}
+
+#if TN_PROFILER
+enum TN_RCode tn_task_profiler_timing_get(
+      const struct TN_Task *task,
+      struct TN_TaskTiming *tgt
+      )
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      int sr_saved;
+      sr_saved = tn_arch_sr_save_int_dis();
+
+      //-- just copy timing data from task structure
+      //   to the user-provided location
+      memcpy(tgt, &task->profiler.timing, sizeof(*tgt));
 
+#if TN_PROFILER_LIGHT
+      //-- add the values which are not folded into totals yet
+      //   (see TN_PROFILER_LIGHT). Accumulators in the task structure are
+      //   left untouched.
+      tgt->total_run_time  += task->profiler.run_time_acc;
+      tgt->got_running_cnt += task->profiler.got_running_cnt_acc;
+#if TN_PROFILER_WAIT_TIME
+      {
+         int i;
+         for (i = 0; i < TN_WAIT_REASONS_CNT; i++){
+            tgt->total_wait_time[i] += task->profiler.wait_time_acc[i];
+         }
+      }
+#endif
+#endif
+
+      tn_arch_sr_restore(sr_saved);
    }
    return rc;
+}
+#endif
 
+#if TN_FAIR_SHARE
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_weight_set(struct TN_Task *task, unsigned int weight)
+{
+   enum TN_RCode rc = _check_param_generic(task);
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (weight == 0 || weight > TN_FAIR_SHARE_WEIGHT_MAX){
+      rc = TN_RC_WPARAM;
+   } else {
+      TN_UWord sr_saved;
+      sr_saved = tn_arch_sr_save_int_dis();
+
+      task->fs_vruntime_inc = TN_FAIR_SHARE_VRUNTIME_SCALE / weight;
+
+      tn_arch_sr_restore(sr_saved);
+   }
+   return rc;
 }
+#endif
 
+#if TN_TASK_RELEASE_TABLE
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_sleep(TN_TickCnt timeout)
+enum TN_RCode tn_task_release_table_set(
+      const struct TN_TaskRelease *table,
+      int entries_cnt,
+      TN_TickCnt hyperperiod,
+      TN_CBTaskOverrun *cb_overrun
+      )
 {
-   enum TN_RCode rc;
+   enum TN_RCode rc = TN_RC_OK;
+   int i;
 
-   if (timeout == 0){
-      rc = TN_RC_TIMEOUT;
+   if (entries_cnt < 0 || (entries_cnt > 0 && table == TN_NULL)){
+      rc = TN_RC_WPARAM;
+   } else if (entries_cnt > 0 && (0
+            || hyperperiod == 0
+            || hyperperiod > (TN_WAIT_INFINITE >> 1)
+            ))
+   {
+      rc = TN_RC_WPARAM;
+   } else {
+      //-- check that the table is sorted and all offsets are within the
+      //   hyperperiod
+      for (i = 0; i < entries_cnt; i++){
+         if (0
+               || table[i].offset >= hyperperiod
+               || (i > 0 && table[i].offset < table[i - 1].offset)
+               || _check_param_generic(table[i].task) != TN_RC_OK
+            )
+         {
+            rc = TN_RC_WPARAM;
+            break;
+         }
+      }
+   }
+
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
@@ -646,113 +1484,105 @@ enum TN_RCode tn_task_sleep(TN_TickCnt timeout)
 
       TN_INT_DIS_SAVE();
 
-      //-- put task to wait with reason SLEEP and without wait queue.
-      _tn_task_curr_to_wait_action(TN_NULL, TN_WAIT_REASON_SLEEP, timeout);
+      if (_tn_timer_is_valid(&_release_timer)){
+         _tn_timer_cancel(&_release_timer);
+      } else {
+         _tn_timer_create(&_release_timer, _release_timer_func, TN_NULL);
+      }
+
+      _release_table             = table;
+      _release_entries_cnt       = entries_cnt;
+      _release_entry_next        = 0;
+      _release_hyperperiod       = hyperperiod;
+      _release_hyperperiod_start = _tn_timer_sys_time_get();
+      _release_cb_overrun        = cb_overrun;
+
+      if (entries_cnt > 0){
+         if (table[0].offset == 0){
+            //-- tasks with zero offset are released right now
+            _release_timer_func(&_release_timer, TN_NULL);
+         } else {
+            _tn_timer_start_at(
+                  &_release_timer, _release_hyperperiod_start + table[0].offset
+                  );
+         }
+      }
 
       TN_INT_RESTORE();
       _tn_context_switch_pend_if_needed();
-      rc = _tn_curr_run_task->task_wait_rc;
-
    }
 
    return rc;
 }
+#endif
 
+#if TN_TASK_GROUPS
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_wakeup(struct TN_Task *task)
-{
-   return _task_job_perform(task, _task_wakeup);
-}
-
-/*
- * See comments in the header file (tn_tasks.h)
- */
-enum TN_RCode tn_task_iwakeup(struct TN_Task *task)
-{
-   return _task_job_iperform(task, _task_wakeup);
-}
-
-/*
- * See comments in the header file (tn_tasks.h)
- */
-enum TN_RCode tn_task_activate(struct TN_Task *task)
+enum TN_RCode tn_task_group_create(struct TN_TaskGroup *group)
 {
-   return _task_job_perform(task, _tn_task_activate);
-}
+   enum TN_RCode rc = _check_param_group_create(group);
 
-/*
- * See comments in the header file (tn_tasks.h)
- */
-enum TN_RCode tn_task_iactivate(struct TN_Task *task)
-{
-   return _task_job_iperform(task, _tn_task_activate);
-}
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else {
+      _tn_list_reset(&(group->tasks));
+      group->id_task_group = TN_ID_TASK_GROUP;
+   }
 
-/*
- * See comments in the header file (tn_tasks.h)
- */
-enum TN_RCode tn_task_release_wait(struct TN_Task *task)
-{
-   return _task_job_perform(task, _task_release_wait);
+   return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_irelease_wait(struct TN_Task *task)
+enum TN_RCode tn_task_group_delete(struct TN_TaskGroup *group)
 {
-   return _task_job_iperform(task, _task_release_wait);
-}
+   enum TN_RCode rc = _check_param_group(group);
 
-/*
- * See comments in the header file (tn_tasks.h)
- */
-void tn_task_exit(enum TN_TaskExitOpt opts)
-{
-   struct TN_Task *task;
-	 
-   if (!tn_is_task_context()){
-      //-- do nothing, just return
+   if (rc != TN_RC_OK){
+      //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
    } else {
+      TN_INTSAVE_DATA;
 
-      //-- here, we unconditionally disable interrupts:
-      //   this function never returns, and interrupt status is restored
-      //   from different task's stack inside 
-      //   `_tn_arch_context_switch_now_nosave()` call.
-      tn_arch_int_dis();
-
-      task = _tn_curr_run_task;
-
-      //-- clear runnable state of currently running task,
-      //   and terminate it
+      TN_INT_DIS_SAVE();
 
-      _tn_task_clear_runnable(task);
-      _task_terminate(task);
+      //-- detach all member tasks
+      while (!_tn_list_is_empty(&(group->tasks))){
+         struct TN_Task *task = _tn_list_first_entry(
+               &(group->tasks), struct TN_Task, group_queue
+               );
 
-      if ((opts & TN_TASK_EXIT_OPT_DELETE)){
-         //-- after exiting from task, we should delete it as well
-         //   (because appropriate flag was set)
-         _task_delete(task);
+         _tn_list_remove_entry(&(task->group_queue));
+         _tn_list_reset(&(task->group_queue));
+         task->group = TN_NULL;
       }
 
-      //-- interrupts will be enabled inside _tn_arch_context_switch_now_nosave()
-      _tn_arch_context_switch_now_nosave();  
+      group->id_task_group = TN_ID_NONE;
+
+      TN_INT_RESTORE();
    }
 
-   return;
+   return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_terminate(struct TN_Task *task)
+enum TN_RCode tn_task_group_add(
+      struct TN_TaskGroup *group,
+      struct TN_Task *task
+      )
 {
-   enum TN_RCode rc = _check_param_generic(task);
-	 
+   enum TN_RCode rc = _check_param_group(group);
+
    if (rc != TN_RC_OK){
       //-- just return rc as it is
+   } else if ((rc = _check_param_generic(task)) != TN_RC_OK){
+      //-- just return rc as it is
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
@@ -760,148 +1590,175 @@ enum TN_RCode tn_task_terminate(struct TN_Task *task)
 
       TN_INT_DIS_SAVE();
 
-      if (_tn_task_is_dormant(task)){
-         //-- The task is already terminated
+      if (task->group != TN_NULL){
+         //-- task already belongs to some group
          rc = TN_RC_WSTATE;
-      } else if (_tn_curr_run_task == task){
-         //-- Cannot terminate currently running task
-         //   (use tn_task_exit() instead)
-         rc = TN_RC_WCONTEXT;
       } else {
-
-         if (_tn_task_is_runnable(task)){
-            //-- if task is runnable, we must clear runnable state
-            //   before terminating the task
-            _tn_task_clear_runnable(task);
-         } else if (_tn_task_is_waiting(task)){
-            //-- if task is waiting, we must clear waiting state
-            //   before terminating the task.
-            //   No matter what waiting result code we specify:
-            //   nobody is going to read it.
-            _tn_task_clear_waiting(
-                  task,
-                  TN_RC_OK    //-- doesn't matter: nobody will read it
-                  );
-         }
-
-         if (_tn_task_is_suspended(task)){
-            //-- if task is suspended, we must clear suspended state
-            //   before terminating the task
-            _tn_task_clear_suspended(task);
-         }
-
-         //-- eventually, terminate the task
-         _task_terminate(task);
+         _tn_list_add_tail(&(group->tasks), &(task->group_queue));
+         task->group = group;
       }
 
       TN_INT_RESTORE();
-      _tn_context_switch_pend_if_needed();
-
    }
+
    return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_delete(struct TN_Task *task)
+enum TN_RCode tn_task_group_remove(
+      struct TN_TaskGroup *group,
+      struct TN_Task *task
+      )
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   enum TN_RCode rc = _check_param_group(group);
 
    if (rc != TN_RC_OK){
       //-- just return rc as it is
+   } else if ((rc = _check_param_generic(task)) != TN_RC_OK){
+      //-- just return rc as it is
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
       TN_INTSAVE_DATA;
 
       TN_INT_DIS_SAVE();
-      rc = _task_delete(task);
-      TN_INT_RESTORE();
 
+      if (task->group != group){
+         //-- task doesn't belong to this group
+         rc = TN_RC_WSTATE;
+      } else {
+         _tn_list_remove_entry(&(task->group_queue));
+         _tn_list_reset(&(task->group_queue));
+         task->group = TN_NULL;
+      }
+
+      TN_INT_RESTORE();
    }
+
    return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_state_get(
-      struct TN_Task *task,
-      enum TN_TaskState *p_state
-      )
+enum TN_RCode tn_task_group_suspend(struct TN_TaskGroup *group)
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   enum TN_RCode rc = _check_param_group(group);
+
    if (rc != TN_RC_OK){
       //-- just return rc as it is
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
+      struct TN_Task *task;
       TN_INTSAVE_DATA;
 
       TN_INT_DIS_SAVE();
-      *p_state = task->task_state;
+
+      _tn_list_for_each_entry(
+            task, struct TN_Task, &(group->tasks), group_queue
+            )
+      {
+         //-- tasks in wrong state (already suspended or dormant)
+         //   are just skipped
+         _task_suspend(task);
+      }
+
       TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
    }
+
    return rc;
 }
 
 /*
  * See comments in the header file (tn_tasks.h)
  */
-enum TN_RCode tn_task_change_priority(struct TN_Task *task, int new_priority)
+enum TN_RCode tn_task_group_resume(struct TN_TaskGroup *group)
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   enum TN_RCode rc = _check_param_group(group);
 
    if (rc != TN_RC_OK){
       //-- just return rc as it is
-   } else if (new_priority < 0 || new_priority >= (TN_PRIORITIES_CNT - 1)){
-      rc = TN_RC_WPARAM;
    } else if (!tn_is_task_context()){
       rc = TN_RC_WCONTEXT;
    } else {
+      struct TN_Task *task;
       TN_INTSAVE_DATA;
 
       TN_INT_DIS_SAVE();
 
-      if (new_priority == 0){
-         new_priority = task->base_priority;
-      }
-
-      rc = TN_RC_OK;
-
-      if (_tn_task_is_dormant(task)){
-         rc = TN_RC_WSTATE;
-      } else {
-         _tn_change_task_priority(task, new_priority);
+      _tn_list_for_each_entry(
+            task, struct TN_Task, &(group->tasks), group_queue
+            )
+      {
+         //-- tasks which aren't suspended are just skipped
+         _task_resume(task);
       }
 
       TN_INT_RESTORE();
       _tn_context_switch_pend_if_needed();
    }
+
    return rc;
 }
 
-#if TN_PROFILER
-enum TN_RCode tn_task_profiler_timing_get(
-      const struct TN_Task *task,
-      struct TN_TaskTiming *tgt
+/*
+ * See comments in the header file (tn_tasks.h)
+ */
+enum TN_RCode tn_task_group_priority_shift(
+      struct TN_TaskGroup *group,
+      int delta
       )
 {
-   enum TN_RCode rc = _check_param_generic(task);
+   enum TN_RCode rc = _check_param_group(group);
 
    if (rc != TN_RC_OK){
       //-- just return rc as it is
+   } else if (!tn_is_task_context()){
+      rc = TN_RC_WCONTEXT;
    } else {
-      int sr_saved;
-      sr_saved = tn_arch_sr_save_int_dis();
+      struct TN_Task *task;
+      TN_INTSAVE_DATA;
 
-      //-- just copy timing data from task structure
-      //   to the user-provided location
-      memcpy(tgt, &task->profiler.timing, sizeof(*tgt));
+      TN_INT_DIS_SAVE();
 
-      tn_arch_sr_restore(sr_saved);
+      _tn_list_for_each_entry(
+            task, struct TN_Task, &(group->tasks), group_queue
+            )
+      {
+         int old_base_priority = task->base_priority;
+         int new_base_priority = old_base_priority + delta;
+
+         //-- clamp priority: the lowest one is reserved for idle task
+         if (new_base_priority < 0){
+            new_base_priority = 0;
+         } else if (new_base_priority > (TN_PRIORITIES_CNT - 2)){
+            new_base_priority = (TN_PRIORITIES_CNT - 2);
+         }
+
+         task->base_priority = new_base_priority;
+
+         if (_tn_task_is_dormant(task)){
+            //-- current priority will be set from base one on activation
+            task->priority = new_base_priority;
+         } else if (0
+               || task->priority == old_base_priority
+               || task->priority > new_base_priority
+               )
+         {
+            //-- task priority isn't elevated by mutex, or new base priority
+            //   is higher than the elevated one: set new priority
+            _tn_change_task_priority(task, new_base_priority);
+         }
+      }
+
+      TN_INT_RESTORE();
+      _tn_context_switch_pend_if_needed();
    }
+
    return rc;
 }
 #endif
@@ -933,10 +1790,20 @@ void _tn_task_set_runnable(struct TN_Task * task)
    //-- Add the task to the end of 'ready queue' for the current priority
    _add_entry_to_ready_queue(&(task->task_queue), priority);
 
+#if TN_LAZY_SCHED
+   //-- next task to run will be looked for later, see _tn_next_task_resolve()
+   _tn_next_task_dirty = TN_TRUE;
+#else
    //-- less value - greater priority, so '<' operation is used here
-   if (priority < _tn_next_task_to_run->priority){
+   if (priority < _tn_next_task_to_run->priority
+#if TN_TIME_PARTITIONS
+         && (_tn_ready_to_run_mask & (1 << priority))
+#endif
+      )
+   {
       _tn_next_task_to_run = task;
    }
+#endif
 }
 
 /**
@@ -965,6 +1832,12 @@ void _tn_task_clear_runnable(struct TN_Task *task)
    task->task_state &= ~TN_TASK_STATE_RUNNABLE;
 
    //-- remove the curr task from any queue (now - from ready queue)
+#if TN_LAZY_SCHED
+   _remove_entry_from_ready_queue(&(task->task_queue), priority);
+
+   //-- next task to run will be looked for later, see _tn_next_task_resolve()
+   _tn_next_task_dirty = TN_TRUE;
+#else
    if (_remove_entry_from_ready_queue(&(task->task_queue), priority)){
       //-- No ready tasks for the curr priority
 
@@ -986,6 +1859,7 @@ void _tn_task_clear_runnable(struct TN_Task *task)
          //-- _tn_next_task_to_run was just altered, so, we should return TN_TRUE
       }
    }
+#endif
 
    //-- and reset task's queue
    _tn_list_reset(&(task->task_queue));
@@ -1005,9 +1879,13 @@ void _tn_task_set_waiting(
       _TN_FATAL_ERROR("");
    } else if (timeout == 0){
       _TN_FATAL_ERROR("");
-   } else if (_tn_timer_is_active(&task->timer)){
+   }
+#if !TN_LAZY_TIMEOUT
+   //-- with TN_LAZY_TIMEOUT, stale timer might be still running here
+   else if (_tn_timer_is_active(&task->timer)){
       _TN_FATAL_ERROR("");
    }
+#endif
 
 #endif
 
@@ -1026,8 +1904,30 @@ void _tn_task_set_waiting(
       //   it is already reset in _tn_task_clear_runnable().
    }
 
+#if TN_LAZY_TIMEOUT
+   if (timeout != TN_WAIT_INFINITE){
+      task->timeout_deadline = _tn_timer_sys_time_get() + timeout;
+      task->timeout_armed = 1;
+
+      if (     !_tn_timer_is_active(&task->timer)
+            || _tn_timer_time_left(&task->timer) > timeout
+            || timeout > (TN_WAIT_INFINITE >> 1)
+         )
+      {
+         //-- there's no stale timer, or it fires too late, or the timeout
+         //   is too long for the rest of it to be told apart from an
+         //   expired deadline in _task_wait_timeout(): (re)start it
+         _tn_timer_start(&task->timer, timeout);
+      } else {
+         //-- stale timer fires not later than needed: just reuse it,
+         //   it will be restarted for the rest of the timeout in
+         //   _task_wait_timeout()
+      }
+   }
+#else
    //-- Add to the timers queue, if timeout is neither 0 nor `TN_WAIT_INFINITE`.
    _tn_timer_start(&task->timer, timeout);
+#endif
 }
 
 /**
@@ -1071,9 +1971,15 @@ void _tn_task_clear_waiting(struct TN_Task *task, enum TN_RCode wait_rc)
    task->pwait_queue  = TN_NULL;
    task->task_wait_rc = wait_rc;
 
+#if TN_LAZY_TIMEOUT
+   //-- if timer is active (i.e. task waits for timeout), don't cancel it:
+   //   just mark it stale, see _task_wait_timeout()
+   task->timeout_armed = 0;
+#else
    //-- if timer is active (i.e. task waits for timeout),
    //   cancel that timer
    _tn_timer_cancel(&task->timer);
+#endif
 
    //-- remove WAIT state
    task->task_state &= ~TN_TASK_STATE_WAIT;
@@ -1134,6 +2040,9 @@ void _tn_task_set_dormant(struct TN_Task* task)
    task->task_state  |= TN_TASK_STATE_DORMANT;   //-- Task state
 
    task->tslice_count  = 0;
+#if TN_FAIR_SHARE
+   task->fs_vruntime   = 0;
+#endif
 }
 
 void _tn_task_clear_dormant(struct TN_Task *task)
@@ -1217,6 +2126,46 @@ TN_BOOL _tn_task_first_wait_complete(
 }
 
 
+#if TN_TIME_PARTITIONS
+/**
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_next_to_run_find(void)
+{
+   _find_next_task_to_run();
+}
+#endif
+
+#if TN_LAZY_SCHED
+/**
+ * See comment in the _tn_sys.h file
+ */
+void _tn_next_task_dirty_resolve(void)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   _find_next_task_to_run();
+   tn_arch_sr_restore(sr_saved);
+}
+#endif
+
+#if TN_FAIR_SHARE
+/**
+ * See comment in the _tn_tasks.h file
+ */
+void _tn_task_fair_share_requeue(struct TN_Task *task)
+{
+   struct TN_ListItem *pri_queue = &(_tn_tasks_ready_list[task->priority]);
+
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   _tn_list_remove_entry(&(task->task_queue));
+
+   //-- the whole queue is searched: the task being moved is the running one
+   _fs_insert(task, pri_queue, pri_queue->next);
+}
+#endif
+
 /**
  * See comment in the _tn_tasks.h file
  */
@@ -1246,7 +2195,11 @@ void _tn_change_running_task_priority(struct TN_Task *task, int new_priority)
    //-- Add task to the end of ready queue for current priority
    _add_entry_to_ready_queue(&(task->task_queue), new_priority);
 
+#if TN_LAZY_SCHED
+   _tn_next_task_dirty = TN_TRUE;
+#else
    _find_next_task_to_run();
+#endif
 }
 
 #if 0
@@ -1297,6 +2250,43 @@ void _tn_task_exit_nodelete(void)
    tn_task_exit((enum TN_TaskExitOpt)(0));
 }
 
+#if TN_STACK_FILL_LAZY
+/*
+ * See comment in the _tn_tasks.h file
+ */
+TN_BOOL _tn_task_stack_fill_lazy_step(void)
+{
+   //-- It's not needed to disable interrupts for checking the counter, since
+   //   it is read by just one assembler instruction, and it is re-checked
+   //   with interrupts disabled below anyway.
+   if (_stack_fill_pending_cnt > 0){
+      TN_INTSAVE_DATA;
+      struct TN_Task *task;
+
+      TN_INT_DIS_SAVE();
+
+      //-- find first task whose stack isn't completely filled yet.
+      //   The idle task is running now, so all the other tasks are not,
+      //   and their saved stack pointers are valid.
+      _tn_list_for_each_entry(
+            task, struct TN_Task, &_tn_tasks_created_list, create_queue
+            )
+      {
+         if (task->stack_fill_pt != TN_NULL){
+            if (_stack_fill_chunk(task)){
+               _stack_fill_pending_cnt--;
+            }
+            break;
+         }
+      }
+
+      TN_INT_RESTORE();
+   }
+
+   return (_stack_fill_pending_cnt > 0);
+}
+#endif
+
 
 
 #if !defined(_TN_ARCH_STACK_DIR)
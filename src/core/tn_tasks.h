@@ -74,6 +74,12 @@
  * `tn_task_activate()`. If task was deleted, it can't be just activated: it
  * should be re-created by `tn_task_create()` first.
  *
+ * If some task should be re-spawned periodically, it's better to let it
+ * just exit (without deleting) and re-activate it by `tn_task_activate()`
+ * instead of deleting and re-creating: activation merely sets up the initial
+ * context frame on the task's stack, while `tn_task_create()` fills the whole
+ * stack with `#TN_FILL_STACK_VAL` (see also `#TN_STACK_FILL_LAZY`).
+ *
  * Task stops execution when:
  *
  * - it calls `tn_task_exit()`;
@@ -124,6 +130,8 @@
 #include "tn_dqueue.h"
 #include "tn_fmem.h"
 #include "tn_timer.h"
+#include "tn_async.h"
+#include "tn_ratelimit.h"
 
 
 
@@ -208,6 +216,14 @@ enum TN_WaitReason {
    /// memory blocks
    /// @see tn_fmem.h
    TN_WAIT_REASON_WFIXMEM,
+   ///
+   /// Task waits for some asynchronous wait to complete
+   /// @see tn_async.h
+   TN_WAIT_REASON_ASYNC_COMPL,
+   ///
+   /// Task waits for tokens of the rate limiter
+   /// @see tn_ratelimit.h
+   TN_WAIT_REASON_RATELIMIT,
 
 
    ///
@@ -267,7 +283,7 @@ struct TN_TaskTiming {
    unsigned long long   got_running_cnt;
    ///
    /// Maximum consecutive time task was running.
-   unsigned long        max_consecutive_run_time;
+   TN_TickCnt           max_consecutive_run_time;
 
 #if TN_PROFILER_WAIT_TIME || DOXYGEN_ACTIVE
    ///
@@ -290,7 +306,7 @@ struct TN_TaskTiming {
    /// reasons of waiting.
    ///
    /// @see `total_wait_time`
-   unsigned long        max_consecutive_wait_time[ TN_WAIT_REASONS_CNT ];
+   TN_TickCnt           max_consecutive_wait_time[ TN_WAIT_REASONS_CNT ];
 #endif
 };
 
@@ -311,6 +327,28 @@ struct _TN_TaskProfiler {
    enum TN_WaitReason   last_wait_reason;
 #endif
 
+#if TN_PROFILER_LIGHT || DOXYGEN_ACTIVE
+   ///
+   /// Available if only `#TN_PROFILER_LIGHT` option is non-zero.
+   ///
+   /// Run time which isn't added to `timing.total_run_time` yet.
+   unsigned long        run_time_acc;
+   ///
+   /// Available if only `#TN_PROFILER_LIGHT` option is non-zero.
+   ///
+   /// Number of times task got running, which isn't added to
+   /// `timing.got_running_cnt` yet.
+   unsigned long        got_running_cnt_acc;
+#if TN_PROFILER_WAIT_TIME || DOXYGEN_ACTIVE
+   ///
+   /// Available if only `#TN_PROFILER_LIGHT` and `#TN_PROFILER_WAIT_TIME`
+   /// options are non-zero.
+   ///
+   /// Wait time which isn't added to `timing.total_wait_time` yet.
+   unsigned long        wait_time_acc[ TN_WAIT_REASONS_CNT ];
+#endif
+#endif
+
 #if TN_DEBUG
    ///
    /// For internal profiler self-check only: indicates whether task is 
@@ -354,6 +392,17 @@ struct TN_Task {
    /// (currently, this list is used for statistics only)
    struct TN_ListItem create_queue;
 
+#if TN_TASK_GROUPS || DOXYGEN_ACTIVE
+   ///
+   /// queue is used to include task in the list of members of its group,
+   /// see `struct #TN_TaskGroup`. Available if only `#TN_TASK_GROUPS` is
+   /// non-zero.
+   struct TN_ListItem group_queue;
+   ///
+   /// group the task belongs to, or `TN_NULL`.
+   struct TN_TaskGroup *group;
+#endif
+
 #if TN_USE_MUTEXES
    ///
    /// list of all mutexes that are locked by task
@@ -366,6 +415,14 @@ struct TN_Task {
    ///
    /// @see `#TN_MUTEX_DEADLOCK_DETECT`
    struct TN_ListItem deadlock_list;
+#if TN_MUTEX_DEADLOCK_DETECT_DEFER
+   ///
+   /// queue is used to include task in the list of tasks which should be
+   /// checked for deadlock by the idle task.
+   ///
+   /// @see `#TN_MUTEX_DEADLOCK_DETECT_DEFER`
+   struct TN_ListItem deadlock_check_queue;
+#endif
 #endif
 #endif
 
@@ -377,6 +434,14 @@ struct TN_Task {
    ///   it's always the highest address (which may be actually origin 
    ///   or end of stack, depending on the architecture)
    TN_UWord *stack_high_addr;
+#if TN_STACK_FILL_LAZY || DOXYGEN_ACTIVE
+   ///
+   /// Boundary of the stack region which is already filled with
+   /// `#TN_FILL_STACK_VAL`: the region spans from the end of stack up to
+   /// this address (not including it). `#TN_NULL` if the whole stack is
+   /// filled. Available if only `#TN_STACK_FILL_LAZY` is non-zero.
+   TN_UWord *stack_fill_pt;
+#endif
    ///
    /// pointer to task's body function given to `tn_task_create()`
    TN_TaskBody *task_func_addr;
@@ -406,6 +471,23 @@ struct TN_Task {
    ///
    /// time slice counter
    int tslice_count;
+#if TN_LAZY_TIMEOUT || DOXYGEN_ACTIVE
+   ///
+   /// System tick count at which the current wait times out (relevant if
+   /// only `timeout_armed` is set). Available if only `#TN_LAZY_TIMEOUT` is
+   /// non-zero.
+   TN_TickCnt timeout_deadline;
+#endif
+#if TN_FAIR_SHARE || DOXYGEN_ACTIVE
+   ///
+   /// Virtual run time, see `#TN_FAIR_SHARE`. Compared with wrap-around
+   /// in mind, so only differences between tasks matter.
+   unsigned long fs_vruntime;
+   ///
+   /// Value added to `fs_vruntime` on each tick while task is running:
+   /// `#TN_FAIR_SHARE_VRUNTIME_SCALE` divided by the weight of the task.
+   unsigned long fs_vruntime_inc;
+#endif
 #if 0
    ///
    /// last operation result code, might be used if some service
@@ -426,6 +508,16 @@ struct TN_Task {
       ///
       /// fields specific to tn_fmem.h
       struct TN_FMemTaskWait fmem;
+#if TN_ASYNC_WAIT || DOXYGEN_ACTIVE
+      ///
+      /// fields specific to tn_async.h
+      struct TN_AsyncComplTaskWait async_compl;
+#endif
+#if TN_RATE_LIMITER || DOXYGEN_ACTIVE
+      ///
+      /// fields specific to tn_ratelimit.h
+      struct TN_RateLimiterTaskWait ratelimit;
+#endif
    } subsys_wait;
    ///
    /// Task name for debug purposes, user may want to set it by hand
@@ -446,11 +538,73 @@ struct TN_Task {
    /// if the caller is interested in the relevant value of this flag.
    unsigned          waited : 1;
 
+#if TN_LAZY_TIMEOUT || DOXYGEN_ACTIVE
+   /// Flag indicates that task waits with finite timeout; if it is cleared
+   /// while the timer of the task is running, the timer is stale (see
+   /// `#TN_LAZY_TIMEOUT`). Available if only `#TN_LAZY_TIMEOUT` is non-zero.
+   unsigned          timeout_armed : 1;
+#endif
+
 
 // Other implementation specific fields may be added below
 
 };
 
+#if TN_TASK_RELEASE_TABLE || DOXYGEN_ACTIVE
+/**
+ * Entry of the time-triggered release table, see
+ * `tn_task_release_table_set()`.
+ *
+ * Available if only `#TN_TASK_RELEASE_TABLE` option is non-zero.
+ */
+struct TN_TaskRelease {
+   ///
+   /// Offset from the beginning of the hyperperiod, in system ticks.
+   TN_TickCnt offset;
+   ///
+   /// Task to release.
+   struct TN_Task *task;
+};
+
+/**
+ * Prototype for the function which is called by the kernel when the task
+ * from the release table (see `tn_task_release_table_set()`) can't be
+ * released because it isn't done with the previous job yet.
+ *
+ * It is called from the $(TN_SYS_TIMER_LINK) interrupt, with interrupts
+ * disabled, so it should be as short as possible; and it isn't allowed to
+ * call any kernel services from it.
+ *
+ * @param task
+ *    Task which has overrun.
+ */
+typedef void (TN_CBTaskOverrun)(struct TN_Task *task);
+#endif
+
+#if TN_TASK_GROUPS || DOXYGEN_ACTIVE
+/**
+ * Task group: a set of tasks which can be suspended, resumed or have their
+ * priority shifted at once, in one critical section and with a single
+ * scheduling decision. Typically used for switching between operating modes
+ * of the application (say, normal → degraded → safe), when a lot of tasks
+ * should be stopped or started.
+ *
+ * Each task can belong to at most one group.
+ *
+ * Available if only `#TN_TASK_GROUPS` option is non-zero.
+ */
+struct TN_TaskGroup {
+   ///
+   /// id for object validity verification.
+   /// This field is in the beginning of the structure to make it easier
+   /// to detect memory corruption.
+   enum TN_ObjId id_task_group;
+   ///
+   /// list of member tasks
+   struct TN_ListItem tasks;
+};
+#endif
+
 
 
 /*******************************************************************************
@@ -461,6 +615,23 @@ struct TN_Task {
  *    DEFINITIONS
  ******************************************************************************/
 
+#if TN_FAIR_SHARE || DOXYGEN_ACTIVE
+/**
+ * Virtual run time added on each tick to the running task with weight 1,
+ * see `#TN_FAIR_SHARE`. For task with weight `w`, it is divided by `w`.
+ */
+#define  TN_FAIR_SHARE_VRUNTIME_SCALE     0x4000UL
+
+/**
+ * Maximum weight of the task, see `tn_task_weight_set()`.
+ */
+#define  TN_FAIR_SHARE_WEIGHT_MAX         255
+
+/**
+ * Default weight of the task, see `tn_task_weight_set()`.
+ */
+#define  TN_FAIR_SHARE_WEIGHT_DEF         16
+#endif
 
 
 
@@ -647,6 +818,30 @@ enum TN_RCode tn_task_resume(struct TN_Task *task);
  */
 enum TN_RCode tn_task_sleep(TN_TickCnt timeout);
 
+/**
+ * Give up the CPU voluntarily: current task is moved to the tail of the
+ * ready-to-run queue of its priority level, so that the next runnable task
+ * of the same priority (if any) runs.
+ *
+ * If `#TN_PREEMPTIVE` is zero, this is also the point at which
+ * higher-priority tasks made runnable in the meantime (by other tasks or by
+ * interrupts) get the CPU. Otherwise, they have already preempted the
+ * current task, so `tn_task_yield()` is useful only for tasks of the same
+ * priority.
+ *
+ * If there are no other runnable tasks of the same or higher priority,
+ * the current task just goes on.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @returns
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context.
+ */
+enum TN_RCode tn_task_yield(void);
+
 /**
  * Wake up task from sleep.
  *
@@ -888,6 +1083,239 @@ enum TN_RCode tn_task_profiler_timing_get(
 #endif
 
 
+#if TN_FAIR_SHARE || DOXYGEN_ACTIVE
+/**
+ * Set weight of the task for fair-share scheduling, see `#TN_FAIR_SHARE`.
+ * Tasks of the same priority (with round-robin enabled for it) get CPU
+ * time proportional to their weights. Weight can be changed at any time.
+ *
+ * Available if only `#TN_FAIR_SHARE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param task
+ *    Task to set weight of
+ * @param weight
+ *    New weight, from 1 to `#TN_FAIR_SHARE_WEIGHT_MAX`.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WPARAM` if `weight` is out of range;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_weight_set(struct TN_Task *task, unsigned int weight);
+#endif
+
+#if TN_TASK_RELEASE_TABLE || DOXYGEN_ACTIVE
+/**
+ * Set static schedule table for time-triggered task release (see
+ * `#TN_TASK_RELEASE_TABLE`). The hyperperiod starts right now, and it
+ * repeats cyclically, until the table is set again or turned off.
+ *
+ * At each offset from the table, all tasks scheduled for that offset are
+ * released, in the order in which they are listed in the table:
+ *
+ *   - if the task is $(TN_TASK_STATE_DORMANT), it is activated (so, the task
+ *     may do its job and then call `tn_task_exit()`);
+ *   - if the task sleeps in `tn_task_sleep()`, it is woken up (so, the task
+ *     may do its job in the infinite loop, calling
+ *     `tn_task_sleep(#TN_WAIT_INFINITE)` at the end of it);
+ *   - otherwise, the task hasn't finished its previous job: this is an
+ *     overrun, and `cb_overrun` is called (if not `TN_NULL`).
+ *
+ * All releases at the same offset lead to a single scheduling decision,
+ * and the whole table needs just one timer.
+ *
+ * Available if only `#TN_TASK_RELEASE_TABLE` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param table
+ *    Schedule table, sorted by `offset` in ascending order. Offsets should
+ *    be less than `hyperperiod`. The kernel doesn't copy the table, so it
+ *    should be valid while it is in use (typically, it is a `const` array).
+ * @param entries_cnt
+ *    Number of entries in the table. If `0`, time-triggered release is
+ *    turned off.
+ * @param hyperperiod
+ *    Length of the hyperperiod, in system ticks. Can't be `0` or more than
+ *    `(#TN_WAIT_INFINITE / 2)`.
+ * @param cb_overrun
+ *    Function to call on overrun, may be `TN_NULL`. See
+ *    `#TN_CBTaskOverrun`.
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WPARAM` if the table or hyperperiod are invalid.
+ */
+enum TN_RCode tn_task_release_table_set(
+      const struct TN_TaskRelease *table,
+      int entries_cnt,
+      TN_TickCnt hyperperiod,
+      TN_CBTaskOverrun *cb_overrun
+      );
+#endif
+
+#if TN_TASK_GROUPS || DOXYGEN_ACTIVE
+/**
+ * Construct task group. `id_task_group` field should not contain
+ * `#TN_ID_TASK_GROUP`, otherwise, `#TN_RC_WPARAM` is returned.
+ *
+ * Available if only `#TN_TASK_GROUPS` option is non-zero.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group
+ *    Pointer to already allocated `struct #TN_TaskGroup`.
+ *
+ * @return
+ *    * `#TN_RC_OK` if group was successfully created;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return code
+ *      is available: `#TN_RC_WPARAM`.
+ */
+enum TN_RCode tn_task_group_create(struct TN_TaskGroup *group);
+
+/**
+ * Destruct task group. All member tasks are removed from the group; their
+ * states aren't changed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to destruct
+ *
+ * @return
+ *    * `#TN_RC_OK` if group was successfully deleted;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_delete(struct TN_TaskGroup *group);
+
+/**
+ * Add task to the group. The task should not belong to any group.
+ *
+ * When task is deleted by `tn_task_delete()`, it is removed from its group
+ * automatically.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to add task to
+ * @param task       task to add
+ *
+ * @return
+ *    * `#TN_RC_OK` if task was successfully added;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WSTATE` if task already belongs to some group;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_add(
+      struct TN_TaskGroup *group,
+      struct TN_Task *task
+      );
+
+/**
+ * Remove task from the group. Task state isn't changed.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to remove task from
+ * @param task       task to remove
+ *
+ * @return
+ *    * `#TN_RC_OK` if task was successfully removed;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * `#TN_RC_WSTATE` if task doesn't belong to the given group;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_remove(
+      struct TN_TaskGroup *group,
+      struct TN_Task *task
+      );
+
+/**
+ * Suspend all member tasks of the group, just like `tn_task_suspend()`
+ * does, but in one critical section, and context switch (if needed) happens
+ * once, after all tasks are suspended. Tasks which are already suspended or
+ * dormant are skipped.
+ *
+ * If current task belongs to the group, it is suspended as well.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to suspend tasks of
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_suspend(struct TN_TaskGroup *group);
+
+/**
+ * Resume all suspended member tasks of the group, just like
+ * `tn_task_resume()` does, but in one critical section, and context switch
+ * (if needed) happens once, after all tasks are resumed. Tasks which aren't
+ * suspended are skipped.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to resume tasks of
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_resume(struct TN_TaskGroup *group);
+
+/**
+ * Shift base priority of all member tasks of the group by `delta` (negative
+ * value means more urgent priority, since less value means higher
+ * priority). The resulting priority is clamped to the range of valid task
+ * priorities: from `0` to `(#TN_PRIORITIES_CNT - 2)`.
+ *
+ * If some task has its priority elevated because of mutex priority
+ * inheritance or ceiling, the elevated priority is kept unless the new
+ * base priority is higher.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CAN_SWITCH_CONTEXT)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param group      group to shift priorities of
+ * @param delta      value to add to the base priority of each task
+ *
+ * @return
+ *    * `#TN_RC_OK` on success;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_task_group_priority_shift(
+      struct TN_TaskGroup *group,
+      int delta
+      );
+#endif
+
 /**
  * Set new priority for task.
  * If priority is 0, then task's base_priority is set.
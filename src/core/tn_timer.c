@@ -47,6 +47,11 @@
 #include "_tn_timer.h"
 #include "_tn_list.h"
 
+#if TN_TIMER_STAT
+//-- std header for memset()
+#include <string.h>
+#endif
+
 
 
 
@@ -54,6 +59,16 @@
  *    PROTECTED DATA
  ******************************************************************************/
 
+#if TN_TIMER_STAT
+//-- see comments in the file _tn_timer.h
+struct TN_TimerStat _tn_timer_stat;
+
+//-- see comments in the file _tn_timer.h
+TN_TimerStatTimeFunc *_tn_timer_stat_time_func = TN_NULL;
+
+//-- see comments in the file _tn_timer.h
+TN_UWord _tn_timer_stat_cb_time_cur;
+#endif
 
 
 /*******************************************************************************
@@ -172,6 +187,23 @@ enum TN_RCode tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
    return rc;
 }
 
+/*
+ * See comments in the header file (tn_timer.h)
+ */
+enum TN_RCode tn_timer_start_at(struct TN_Timer *timer, TN_TickCnt abs_tick)
+{
+   TN_UWord sr_saved;
+   enum TN_RCode rc = _check_param_generic(timer);
+
+   if (rc == TN_RC_OK){
+      sr_saved = tn_arch_sr_save_int_dis();
+      rc = _tn_timer_start_at(timer, abs_tick);
+      tn_arch_sr_restore(sr_saved);
+   }
+
+   return rc;
+}
+
 /*
  * See comments in the header file (tn_timer.h)
  */
@@ -247,6 +279,38 @@ enum TN_RCode tn_timer_time_left(
    return rc;
 }
 
+#if TN_TIMER_STAT
+/*
+ * See comments in the header file (tn_timer.h)
+ */
+enum TN_RCode tn_timer_stat_get(struct TN_TimerStat *p_stat, TN_BOOL reset)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+
+   if (p_stat != TN_NULL){
+      *p_stat = _tn_timer_stat;
+   }
+
+   if (reset){
+      memset(&_tn_timer_stat, 0x00, sizeof(_tn_timer_stat));
+   }
+
+   tn_arch_sr_restore(sr_saved);
+
+   return TN_RC_OK;
+}
+
+/*
+ * See comments in the header file (tn_timer.h)
+ */
+void tn_timer_stat_time_func_set(TN_TimerStatTimeFunc *time_func)
+{
+   TN_UWord sr_saved = tn_arch_sr_save_int_dis();
+   _tn_timer_stat_time_func = time_func;
+   tn_arch_sr_restore(sr_saved);
+}
+#endif
+
 
 
 
@@ -256,6 +320,27 @@ enum TN_RCode tn_timer_time_left(
  ******************************************************************************/
 
 
+/**
+ * See comments in the _tn_timer.h file.
+ */
+enum TN_RCode _tn_timer_start_at(struct TN_Timer *timer, TN_TickCnt abs_tick)
+{
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   //-- calculate timeout from the current time. Tick count wraps around,
+   //   so, if the difference is more than half of the whole range, the
+   //   given time is considered as already passed.
+   TN_TickCnt timeout = (TN_TickCnt)(abs_tick - _tn_timer_sys_time_get());
+
+   if (timeout == 0 || timeout > (TN_WAIT_INFINITE >> 1)){
+      //-- time is already reached or passed: fire on the next tick
+      timeout = 1;
+   }
+
+   return _tn_timer_start(timer, timeout);
+}
+
 /**
  * See comments in the _tn_timer.h file.
  */
@@ -283,6 +283,95 @@ typedef TN_TickCnt (TN_CBTickCntGet)(void);
 
 
 
+#if TN_TIMER_STAT || defined(DOXYGEN_ACTIVE)
+
+/**
+ * Available if only `#TN_TIMER_STAT` is non-zero.
+ *
+ * Number of buckets in the timeout histogram, see `struct #TN_TimerStat`.
+ */
+#define TN_TIMER_STAT_HIST_CNT   16
+
+/**
+ * Available if only `#TN_TIMER_STAT` is non-zero.
+ *
+ * Prototype of the function which returns current time in any units
+ * the application finds convenient (typically, a free-running hardware
+ * counter). It is used to measure the time spent in timer callbacks, see
+ * `tn_timer_stat_time_func_set()`. The value is allowed to wrap around.
+ */
+typedef TN_UWord (TN_TimerStatTimeFunc)(void);
+
+/**
+ * Available if only `#TN_TIMER_STAT` is non-zero.
+ *
+ * Statistics of the timer engine, returned by `tn_timer_stat_get()`.
+ * It is intended to help choosing `#TN_TICK_LISTS_CNT`: if a lot of timers
+ * go to the "generic" list and get cascaded, the value is too small;
+ * if most of the "tick" lists are almost always empty, it is too large.
+ *
+ * Counters wrap around silently; reset them periodically if needed.
+ */
+struct TN_TimerStat {
+   ///
+   /// Static tick: number of system ticks processed (with `#TN_HYBRID_TICK`,
+   /// it includes suppressed ticks as well). Dynamic tick: number of calls
+   /// to `tn_tick_int_processing()`.
+   unsigned long ticks_cnt;
+   ///
+   /// Number of timers started (including timeouts of waiting tasks)
+   unsigned long started_cnt;
+   ///
+   /// Static tick only: number of timers started to the "tick" lists, i.e.
+   /// with timeout less than `#TN_TICK_LISTS_CNT`
+   unsigned long started_tick_cnt;
+   ///
+   /// Static tick only: number of timers started to the "generic" list
+   unsigned long started_gen_cnt;
+   ///
+   /// Static tick only: number of times the "generic" list was walked,
+   /// i.e. the number of `#TN_TICK_LISTS_CNT` boundaries at which the list
+   /// was not empty
+   unsigned long cascades_cnt;
+   ///
+   /// Static tick only: total number of timers moved from the "generic"
+   /// list to the "tick" lists
+   unsigned long cascaded_cnt;
+   ///
+   /// Static tick only: total number of timers walked in the "generic"
+   /// list at all boundaries (including ones which stayed there)
+   unsigned long gen_walked_cnt;
+   ///
+   /// Maximum length of the "generic" list walked at once: for the static
+   /// tick, at a `#TN_TICK_LISTS_CNT` boundary; for the dynamic tick, when
+   /// the timer is inserted to the sorted list of active timers.
+   unsigned long gen_list_len_max;
+   ///
+   /// Total number of timers fired
+   unsigned long fired_cnt;
+   ///
+   /// Maximum number of timers fired in a single tick (for the static tick,
+   /// it is the maximum length of the "tick" list)
+   unsigned long fired_per_tick_max;
+   ///
+   /// Maximum time spent in timer callbacks during a single tick, in units
+   /// of the function given to `tn_timer_stat_time_func_set()`. Stays 0 if
+   /// there's no such function.
+   TN_UWord cb_time_max;
+   ///
+   /// Total time spent in timer callbacks, in the same units
+   unsigned long cb_time_total;
+   ///
+   /// Histogram of timeouts the timers are started with: the element `i`
+   /// is the number of timeouts in the range `[2^i, 2^(i+1))`, the last
+   /// one also counts all the larger timeouts.
+   unsigned long timeout_hist[ TN_TIMER_STAT_HIST_CNT ];
+};
+
+#endif
+
+
+
 
 /*******************************************************************************
  *    PROTECTED GLOBAL DATA
@@ -354,7 +443,9 @@ enum TN_RCode tn_timer_delete(struct TN_Timer *timer);
  * @param timeout
  *    Number of system ticks after which timer should fire (i.e. function 
  *    should be called). **Note** that `timeout` can't be `#TN_WAIT_INFINITE` or
- *    `0`.
+ *    `0`. With \ref time_ticks__static_tick, timeouts larger than
+ *    `(#TN_WAIT_INFINITE - #TN_TICK_LISTS_CNT)` are clamped to this value
+ *    (it matters if only `#TN_TICK_CNT_WIDTH` is 16).
  *
  * @return 
  *    * `#TN_RC_OK` if timer was successfully started;
@@ -366,6 +457,43 @@ enum TN_RCode tn_timer_delete(struct TN_Timer *timer);
  */
 enum TN_RCode tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout);
 
+/**
+ * The same as `tn_timer_start()`, but the time at which the timer should
+ * fire is given as an absolute system tick count (as returned by
+ * `tn_sys_time_get()`) instead of a timeout relative to the current time.
+ *
+ * It is useful when the timer should be scheduled relative to some
+ * previously stored event time: the remaining timeout is calculated inside
+ * the critical section, so there's no error introduced by the time elapsed
+ * since the application got the current time, and no extra call to
+ * `tn_sys_time_get()` is needed.
+ *
+ * Since the system tick count wraps around, `abs_tick` is interpreted as
+ * being in the future if it is at most `(#TN_WAIT_INFINITE / 2)` ticks ahead
+ * of the current time; otherwise it is considered as being already in the
+ * past. If the given time is already reached or passed, the timer fires on
+ * the next system tick.
+ *
+ * It is legal to restart already active timer. In this case, the timer will be
+ * cancelled first.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param timer
+ *    Timer to start
+ * @param abs_tick
+ *    System tick count at which timer should fire.
+ *
+ * @return 
+ *    * `#TN_RC_OK` if timer was successfully started;
+ *    * `#TN_RC_WCONTEXT` if called from wrong context;
+ *    * If `#TN_CHECK_PARAM` is non-zero, additional return codes
+ *      are available: `#TN_RC_WPARAM` and `#TN_RC_INVALID_OBJ`.
+ */
+enum TN_RCode tn_timer_start_at(struct TN_Timer *timer, TN_TickCnt abs_tick);
+
 /**
  * If timer is active, cancel it. If timer is already inactive, nothing is
  * changed.
@@ -451,6 +579,46 @@ enum TN_RCode tn_timer_time_left(
       TN_TickCnt *p_time_left
       );
 
+#if TN_TIMER_STAT || defined(DOXYGEN_ACTIVE)
+/**
+ * Available if only `#TN_TIMER_STAT` is non-zero.
+ *
+ * Get statistics of the timer engine, and optionally reset it.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param p_stat
+ *    Pointer to the structure to store the statistics to; may be `TN_NULL`
+ *    if the caller only wants to reset it.
+ * @param reset
+ *    If `TN_TRUE`, all counters are reset after copying.
+ *
+ * @return
+ *    * `#TN_RC_OK` if operation was successfull.
+ */
+enum TN_RCode tn_timer_stat_get(struct TN_TimerStat *p_stat, TN_BOOL reset);
+
+/**
+ * Available if only `#TN_TIMER_STAT` is non-zero.
+ *
+ * Set the function which is used to measure time spent in timer callbacks
+ * (see `cb_time_max` and `cb_time_total` fields of `struct #TN_TimerStat`).
+ * The function is called twice for each fired timer, so it should be fast.
+ * If it's not set (the default), callback time isn't measured.
+ *
+ * $(TN_CALL_FROM_TASK)
+ * $(TN_CALL_FROM_ISR)
+ * $(TN_CALL_FROM_MAIN)
+ * $(TN_LEGEND_LINK)
+ *
+ * @param time_func
+ *    Time function, or `TN_NULL` to stop measuring.
+ */
+void tn_timer_stat_time_func_set(TN_TimerStatTimeFunc *time_func);
+#endif
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
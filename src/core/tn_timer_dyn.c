@@ -69,6 +69,11 @@ TN_CBTickSchedule      *_tn_cb_tick_schedule = TN_NULL;
 //-- see comments in the file _tn_timer_dyn.h
 TN_CBTickCntGet        *_tn_cb_tick_cnt_get  = TN_NULL;
 
+#if TN_IDLE_GOVERNOR
+//-- see comments in the file _tn_timer_dyn.h
+TN_TickCnt             _tn_tick_compensation = 0;
+#endif
+
 
 
 
@@ -133,11 +138,10 @@ static TN_TickCnt _time_left_get(
 }
 
 /**
- * Find out when the kernel needs `tn_tick_int_processing()` to be called next
- * time, and eventually call application callback `_tn_cb_tick_schedule()` with
- * found value.
+ * Get time left until the nearest timer expiration, or `#TN_WAIT_INFINITE`
+ * if there are no active timers.
  */
-static void _next_tick_schedule(TN_TickCnt cur_sys_tick_cnt)
+static TN_TickCnt _next_timeout_get(TN_TickCnt cur_sys_tick_cnt)
 {
    TN_TickCnt next_timeout;
 
@@ -155,8 +159,18 @@ static void _next_tick_schedule(TN_TickCnt cur_sys_tick_cnt)
       next_timeout = TN_WAIT_INFINITE;
    }
 
+   return next_timeout;
+}
+
+/**
+ * Find out when the kernel needs `tn_tick_int_processing()` to be called next
+ * time, and eventually call application callback `_tn_cb_tick_schedule()` with
+ * found value.
+ */
+static void _next_tick_schedule(TN_TickCnt cur_sys_tick_cnt)
+{
    //-- schedule next tick
-   _tn_cb_tick_schedule(next_timeout);
+   _tn_cb_tick_schedule(_next_timeout_get(cur_sys_tick_cnt));
 }
 
 
@@ -203,6 +217,35 @@ void _tn_timer_dyn_callback_set(
 }
 
 
+#if TN_IDLE_GOVERNOR
+/*
+ * See comments in the _tn_timer_dyn.h file.
+ */
+TN_TickCnt _tn_timer_next_timeout_get(void)
+{
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   return _next_timeout_get(_tn_timer_sys_time_get());
+}
+
+/*
+ * See comments in the _tn_timer_dyn.h file.
+ */
+void _tn_timer_tick_compensate(TN_TickCnt ticks)
+{
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   _tn_tick_compensation += ticks;
+
+   //-- timers might have expired while the tick counter was stopped;
+   //   if so, the application is asked to call tn_tick_int_processing()
+   //   right now (timeout 0)
+   _next_tick_schedule(_tn_timer_sys_time_get());
+}
+#endif
+
 /*
  * See comments in the _tn_timer.h file.
  */
@@ -270,6 +313,9 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
    //   through them, firing each one.
    {
       struct TN_Timer *timer;
+#if TN_TIMER_STAT
+      unsigned long fired_cnt = 0;
+#endif
 
       while (!_tn_list_is_empty(&_timer_list__fire)){
          timer = _tn_list_first_entry(
@@ -282,7 +328,15 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
 
          //-- call user callback function
          _tn_timer_callback_call(timer, TN_INTSAVE_VAR);
+
+#if TN_TIMER_STAT
+         fired_cnt++;
+#endif
       }
+
+#if TN_TIMER_STAT
+      _tn_timer_stat_tick_done(fired_cnt);
+#endif
    }
 
    //-- Find out when `tn_tick_int_processing()` should be called next time,
@@ -321,6 +375,9 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
       {
          struct TN_Timer *timer;
          struct TN_Timer *tmp_timer;
+#if TN_TIMER_STAT
+         unsigned long walked_cnt = 0;
+#endif
 
          _tn_list_for_each_entry_safe(
                timer, struct TN_Timer, tmp_timer,
@@ -330,6 +387,10 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
             //-- timeout value should never be TN_WAIT_INFINITE.
             _TN_BUG_ON(timer->timeout == TN_WAIT_INFINITE);
 
+#if TN_TIMER_STAT
+            walked_cnt++;
+#endif
+
             if (_time_left_get(timer, cur_sys_tick_cnt) < timeout){
                //-- Probably this is the place for new timer..
                list_item = &timer->timer_queue;
@@ -339,6 +400,11 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
                break;
             }
          }
+
+#if TN_TIMER_STAT
+         _tn_timer_stat_start(timeout);
+         _tn_timer_stat_gen_len(walked_cnt);
+#endif
       }
 
       //-- put timer object at the right position.
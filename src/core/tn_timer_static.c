@@ -109,6 +109,15 @@ volatile TN_TickCnt _tn_sys_time_count;
 #define _TICK_LIST_INDEX(timeout)    \
    (((TN_TickCnt)_tn_sys_time_count + timeout) & TN_TICK_LISTS_MASK)
 
+/**
+ * Maximum timeout value for which `timeout_cur` of the timer in the "generic"
+ * list can't overflow: `timeout_cur` is the timeout plus current "tick" index
+ * (which is less than `TN_TICK_LISTS_CNT`), and it must not reach
+ * `#TN_WAIT_INFINITE`.
+ */
+#define _TN_TIMER_STATIC_TIMEOUT_MAX   \
+   ((TN_TickCnt)(TN_WAIT_INFINITE - TN_TICK_LISTS_CNT))
+
 
 
 
@@ -169,13 +178,29 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
       //-- handle "generic" timer list {{{
       {
          struct TN_Timer *timer;
-         struct TN_Timer *tmp_timer;
+         struct TN_ListItem not_checked;
+#if TN_PREEMPT_POINT_ITEMS
+         int items_cnt = 0;
+#endif
+#if TN_TIMER_STAT
+         unsigned long walked_cnt = 0;
+#endif
 
-         _tn_list_for_each_entry_safe(
-               timer, struct TN_Timer, tmp_timer,
-               &_tn_timer_list__gen, timer_queue
-               )
-         {
+         //-- Move all timers to the local list of timers which aren't
+         //   handled yet: it serves as a cursor which stays valid even if
+         //   some ISR starts or cancels timers while interrupts are
+         //   enabled below. Timers started meanwhile go to the "generic"
+         //   list directly, so they aren't decremented in this round.
+         //
+         //   NOTE: while interrupts are enabled, `_tn_timer_time_left()`
+         //   returns value which is TN_TICK_LISTS_CNT ticks more than the
+         //   actual one, for the timers which aren't handled yet.
+         _tn_list_move_all(&not_checked, &_tn_timer_list__gen);
+
+         while (!_tn_list_is_empty(&not_checked)){
+            timer = _tn_list_first_entry(
+                  &not_checked, struct TN_Timer, timer_queue
+                  );
 
             //-- timeout value should always be >= TN_TICK_LISTS_CNT here.
             //   And it should never be TN_WAIT_INFINITE.
@@ -186,15 +211,48 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
 
             timer->timeout_cur -= TN_TICK_LISTS_CNT;
 
+            _tn_list_remove_entry(&(timer->timer_queue));
+
+#if TN_TIMER_STAT
+            walked_cnt++;
+#endif
+
             if (timer->timeout_cur < TN_TICK_LISTS_CNT){
                //-- it's time to move this timer to the "tick" list
-               _tn_list_remove_entry(&(timer->timer_queue));
                _tn_list_add_tail(
                      &_tn_timer_list__tick[_TICK_LIST_INDEX(timer->timeout_cur)],
                      &(timer->timer_queue)
                      );
+#if TN_TIMER_STAT
+               _tn_timer_stat.cascaded_cnt++;
+#endif
+            } else {
+               //-- return timer back to the "generic" list
+               _tn_list_add_tail(
+                     &_tn_timer_list__gen, &(timer->timer_queue)
+                     );
+            }
+
+#if TN_PREEMPT_POINT_ITEMS
+            //-- preemption point: briefly enable interrupts, so that
+            //   interrupt latency doesn't depend on the number of timers
+            //   (the same is done for timer callbacks, see
+            //   `_tn_timer_callback_call()`)
+            if (++items_cnt >= TN_PREEMPT_POINT_ITEMS){
+               items_cnt = 0;
+               TN_INT_IRESTORE();
+               TN_INT_IDIS_SAVE();
             }
+#endif
+         }
+
+#if TN_TIMER_STAT
+         if (walked_cnt > 0){
+            _tn_timer_stat.cascades_cnt++;
+            _tn_timer_stat.gen_walked_cnt += walked_cnt;
+            _tn_timer_stat_gen_len(walked_cnt);
          }
+#endif
       }
       //}}}
    }
@@ -206,6 +264,9 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
    //-- handle current "tick" timer list {{{
    {
       struct TN_Timer *timer;
+#if TN_TIMER_STAT
+      unsigned long fired_cnt = 0;
+#endif
 
       struct TN_ListItem *p_cur_timer_list = 
          &_tn_timer_list__tick[ tick_list_index ];
@@ -235,9 +296,17 @@ void _tn_timers_tick_proceed(TN_UWord TN_INTSAVE_VAR)
 
          //-- call user callback function
          _tn_timer_callback_call(timer, TN_INTSAVE_VAR);
+
+#if TN_TIMER_STAT
+         fired_cnt++;
+#endif
       }
 
       _TN_BUG_ON( !_tn_list_is_empty(p_cur_timer_list) );
+
+#if TN_TIMER_STAT
+      _tn_timer_stat_tick_done(fired_cnt);
+#endif
    }
    // }}}
 }
@@ -259,6 +328,10 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
       //-- if timer is active, cancel it first
       if ((rc = _tn_timer_cancel(timer)) == TN_RC_OK){
 
+#if TN_TIMER_STAT
+         _tn_timer_stat_start(timeout);
+#endif
+
          if (timeout < TN_TICK_LISTS_CNT){
             //-- timer should be added to the one of "tick" lists.
             int tick_list_index = _TICK_LIST_INDEX(timeout);
@@ -268,12 +341,27 @@ enum TN_RCode _tn_timer_start(struct TN_Timer *timer, TN_TickCnt timeout)
                   &_tn_timer_list__tick[ tick_list_index ],
                   &(timer->timer_queue)
                   );
+
+#if TN_TIMER_STAT
+            _tn_timer_stat.started_tick_cnt++;
+#endif
          } else {
             //-- timer should be added to the "generic" list.
             //   We should set timeout_cur adding current "tick" index to it.
+            //
+            //   With narrow `TN_TickCnt` (see `TN_TICK_CNT_WIDTH`), the sum
+            //   might overflow for very large timeouts, so the timeout is
+            //   clamped to `_TN_TIMER_STATIC_TIMEOUT_MAX`.
+            if (timeout > _TN_TIMER_STATIC_TIMEOUT_MAX){
+               timeout = _TN_TIMER_STATIC_TIMEOUT_MAX;
+            }
             timer->timeout_cur = timeout + _TICK_LIST_INDEX(0);
 
             _tn_list_add_tail(&_tn_timer_list__gen, &(timer->timer_queue));
+
+#if TN_TIMER_STAT
+            _tn_timer_stat.started_gen_cnt++;
+#endif
          }
       }
    }
@@ -334,6 +422,125 @@ TN_TickCnt _tn_timer_time_left(struct TN_Timer *timer)
    return time_left;
 }
 
+#if TN_HYBRID_TICK
+/**
+ * See comments in the _tn_timer_static.h file.
+ */
+TN_TickCnt _tn_timer_next_timeout_get(void)
+{
+   TN_TickCnt ret = TN_WAIT_INFINITE;
+   TN_TickCnt tick_list_index = _TICK_LIST_INDEX(0);
+   struct TN_Timer *timer;
+   int i;
+
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   //-- the nearest non-empty "tick" list. The current one is always
+   //   empty outside of the tick processing, so start from the next one.
+   for (i = 1; i < TN_TICK_LISTS_CNT; i++){
+      if (!_tn_list_is_empty(
+               &_tn_timer_list__tick[ (tick_list_index + i) & TN_TICK_LISTS_MASK ]
+               )
+         )
+      {
+         ret = i;
+         break;
+      }
+   }
+
+   //-- "generic" list: timeout_cur is counted from the moment when the
+   //   tick index was 0 last time (see `_tn_timer_time_left()`)
+   _tn_list_for_each_entry(
+         timer, struct TN_Timer, &_tn_timer_list__gen, timer_queue
+         )
+   {
+      TN_TickCnt time_left = timer->timeout_cur - tick_list_index;
+
+      if (time_left < ret){
+         ret = time_left;
+      }
+   }
+
+   return ret;
+}
+
+/**
+ * See comments in the _tn_timer_static.h file.
+ */
+void _tn_timer_tick_catch_up(TN_TickCnt ticks)
+{
+   //-- interrupts should be disabled here
+   _TN_BUG_ON( !TN_IS_INT_DISABLED() );
+
+   if (!_tn_list_is_empty(&_tn_timer_list__gen)){
+      //-- Timers in the "generic" list are handled each time the tick
+      //   index becomes 0 (see `_tn_timers_tick_proceed()`): do it for all
+      //   the skipped times at once. Since no timer expires during skipped
+      //   ticks, a timer can be moved to the "tick" list only at the last
+      //   of these times, so the result is the same.
+      TN_TickCnt wraps_cnt = (_TICK_LIST_INDEX(0) + ticks) / TN_TICK_LISTS_CNT;
+
+      if (wraps_cnt > 0){
+         struct TN_Timer *timer;
+         struct TN_ListItem not_checked;
+#if TN_TIMER_STAT
+         unsigned long walked_cnt = 0;
+#endif
+
+         _tn_list_move_all(&not_checked, &_tn_timer_list__gen);
+
+         while (!_tn_list_is_empty(&not_checked)){
+            timer = _tn_list_first_entry(
+                  &not_checked, struct TN_Timer, timer_queue
+                  );
+
+            _TN_BUG_ON(timer->timeout_cur < wraps_cnt * TN_TICK_LISTS_CNT);
+
+            timer->timeout_cur -= wraps_cnt * TN_TICK_LISTS_CNT;
+
+            _tn_list_remove_entry(&(timer->timer_queue));
+
+#if TN_TIMER_STAT
+            walked_cnt++;
+#endif
+
+            if (timer->timeout_cur < TN_TICK_LISTS_CNT){
+               //-- it's time to move this timer to the "tick" list
+               //   (timeout_cur is counted from the last time the tick
+               //   index was 0, so it is the index of the list)
+               _tn_list_add_tail(
+                     &_tn_timer_list__tick[ timer->timeout_cur ],
+                     &(timer->timer_queue)
+                     );
+#if TN_TIMER_STAT
+               _tn_timer_stat.cascaded_cnt++;
+#endif
+            } else {
+               //-- return timer back to the "generic" list
+               _tn_list_add_tail(
+                     &_tn_timer_list__gen, &(timer->timer_queue)
+                     );
+            }
+         }
+
+#if TN_TIMER_STAT
+         //-- all the skipped boundaries are handled in one walk
+         _tn_timer_stat.cascades_cnt++;
+         _tn_timer_stat.gen_walked_cnt += walked_cnt;
+         _tn_timer_stat_gen_len(walked_cnt);
+#endif
+      }
+   }
+
+#if TN_TIMER_STAT
+   _tn_timer_stat.ticks_cnt += ticks;
+#endif
+
+   _tn_sys_time_count += ticks;
+}
+#endif
+
 
 #endif // !TN_DYNAMIC_TICK
 
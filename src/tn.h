@@ -57,6 +57,10 @@
 #include "core/tn_sem.h"
 #include "core/tn_tasks.h"
 #include "core/tn_timer.h"
+#include "core/tn_ao.h"
+#include "core/tn_async.h"
+#include "core/tn_ratelimit.h"
+#include "core/tn_isrrec.h"
 
 
 //-- include old symbols for compatibility with old projects
@@ -192,6 +192,42 @@
 #  define TN_MUTEX_DEADLOCK_DETECT  1
 #endif
 
+/**
+ * Whether deadlock detection (see `#TN_MUTEX_DEADLOCK_DETECT`) is deferred
+ * to the idle task.
+ *
+ * By default, each `tn_mutex_lock()` which has to wait walks through the
+ * chain of mutex holders right away, in the critical section, to check if
+ * the deadlock occurred. If this option is non-zero, the waiting task is
+ * just put to the list of tasks to check (which is O(1)), and the idle task
+ * walks the chains later, one task per critical section. So, contended
+ * locks don't pay for the detection, but the deadlock is reported when the
+ * idle task runs next time.
+ *
+ * Relevant if only `#TN_MUTEX_DEADLOCK_DETECT` is non-zero.
+ */
+#ifndef TN_MUTEX_DEADLOCK_DETECT_DEFER
+#  define TN_MUTEX_DEADLOCK_DETECT_DEFER  0
+#endif
+
+/**
+ * Whether mutexes learn their priority ceilings: each mutex remembers the
+ * highest base priority of all the tasks which ever tried to lock it, no
+ * matter the protocol. The result can be read by `tn_mutex_ceil_learned_get()`
+ * and applied by `tn_mutex_ceil_apply()`, which also switches the mutex to
+ * the `#TN_MUTEX_PROT_CEILING` protocol.
+ *
+ * Additionally, attempts to lock `#TN_MUTEX_PROT_CEILING` mutex by the task
+ * with priority higher than the ceiling are counted and reported via
+ * callback, see `tn_callback_mutex_ceil_violation_set()`.
+ *
+ * Each mutex gets two more fields, and `tn_mutex_lock()` takes a few more
+ * cycles. Intended for development builds.
+ */
+#ifndef TN_MUTEX_CEIL_LEARN
+#  define TN_MUTEX_CEIL_LEARN    0
+#endif
+
 /**
  *
  * <i>Takes effect if only `#TN_DYNAMIC_TICK` is <B>not set</B></i>.
@@ -270,6 +306,26 @@
 #  define TN_PROFILER_WAIT_TIME  0
 #endif
 
+/**
+ * Whether profiler should use lightweight mode: at every context switch,
+ * time is added to 32-bit accumulators instead of 64-bit totals of
+ * `struct #TN_TaskTiming`, and accumulators are folded into totals lazily:
+ * when `tn_task_profiler_timing_get()` is called, or when some accumulator is
+ * about to overflow. It makes the per-switch profiler cost much lower on
+ * 16-bit and small 32-bit cores (PIC24, Cortex-M0), where 64-bit arithmetic
+ * is expensive; the cost is a few more words in `#TN_Task` structure (and
+ * one more word per wait reason, if `#TN_PROFILER_WAIT_TIME` is non-zero).
+ *
+ * Timing data returned by `tn_task_profiler_timing_get()` is the same as
+ * in the regular mode.
+ *
+ * Relevant if only `#TN_PROFILER` is non-zero. Requires `#TN_TICK_CNT_WIDTH`
+ * to be 16 or 32.
+ */
+#ifndef TN_PROFILER_LIGHT
+#  define TN_PROFILER_LIGHT      0
+#endif
+
 /**
  * Whether interrupt stack space should be initialized with
  * `#TN_FILL_STACK_VAL` on system start. It is useful to disable this option if
@@ -325,6 +381,70 @@
 #  endif
 #endif
 
+/**
+ * Whether task stacks should be filled with `#TN_FILL_STACK_VAL` lazily.
+ *
+ * By default (the option is zero), `tn_task_create()` fills the whole task
+ * stack at once. It is done before interrupts are disabled, so it doesn't
+ * affect interrupt latency, but it still takes time proportional to the
+ * stack size, and the system start grows with the total size of all stacks.
+ *
+ * If this option is non-zero, `tn_task_create()` fills only the guard region
+ * of `#TN_STACK_FILL_GUARD_SIZE` words at the end of the stack (which is
+ * enough for `#TN_STACK_OVERFLOW_CHECK` to work), and the rest of the stack
+ * is filled by the idle task, a small chunk at a time, as long as that part
+ * of the stack isn't used by the task.
+ *
+ * Enabling this option bumps the size of `#TN_Task` structure by one pointer.
+ *
+ * \attention
+ * Until the idle task has finished filling the stack of some task, the
+ * stack usage of that task can't be estimated reliably: the region that was
+ * used and released before it was filled will look untouched.
+ */
+#ifndef TN_STACK_FILL_LAZY
+#  define TN_STACK_FILL_LAZY        0
+#endif
+
+/**
+ * Size of the guard region (in `#TN_UWord`s) at the end of each task stack
+ * which is filled by `tn_task_create()` right away, when `#TN_STACK_FILL_LAZY`
+ * is non-zero. The same amount of words is filled by the idle task in one
+ * critical section.
+ *
+ * Relevant if only `#TN_STACK_FILL_LAZY` is non-zero.
+ */
+#ifndef TN_STACK_FILL_GUARD_SIZE
+#  define TN_STACK_FILL_GUARD_SIZE  16
+#endif
+
+
+/**
+ * Width of the `#TN_TickCnt` type, in bits: 16, 32 or 64.
+ *
+ * The narrower type is, the cheaper timer and profiler arithmetic is (for
+ * example, on PIC24/dsPIC each 32-bit operation takes several instructions),
+ * but the maximum timeout value (`#TN_WAIT_INFINITE` - 1) is smaller, and
+ * system time returned by `tn_sys_time_get()` wraps around sooner.
+ *
+ * Pick the narrowest width which fits your timeout range:
+ *
+ * - 16: max timeout is 65534 ticks, time wraps each 65536 ticks (with 1 ms
+ *   tick, that is about one minute);
+ * - 32: max timeout is 4294967294 ticks (about 49 days with 1 ms tick);
+ * - 64: time practically never wraps. Note that on 32-bit (or narrower)
+ *   cores, 64-bit counter can't be read atomically, so
+ *   `tn_sys_time_get()` disables interrupts for a bit longer.
+ *
+ * \attention
+ * When `#TN_DYNAMIC_TICK` is used, callbacks given to
+ * `tn_callback_dyn_tick_set()` should take and return values of the same
+ * width.
+ */
+#ifndef TN_TICK_CNT_WIDTH
+#  define TN_TICK_CNT_WIDTH      32
+#endif
+
 
 /**
  * Whether the kernel should use \ref time_ticks__dynamic_tick scheme instead of
@@ -335,6 +455,294 @@
 #endif
 
 
+/**
+ * Whether the scheduler is preemptive. If zero, the kernel is built in
+ * cooperative mode: context switch happens only when the running task
+ * goes to $(TN_TASK_STATE_WAIT), $(TN_TASK_STATE_SUSPEND) or
+ * $(TN_TASK_STATE_DORMANT) state, or explicitly calls `tn_task_yield()`.
+ *
+ * That is, when some task (or an interrupt) makes higher-priority task
+ * runnable, the higher-priority task doesn't preempt the running one, it
+ * just waits until the running task gives up the CPU. The only exception
+ * is the idle task: it is always preempted as soon as some other task
+ * becomes runnable.
+ *
+ * \ref round_robin "Round-robin" has no effect in cooperative mode.
+ */
+#ifndef TN_PREEMPTIVE
+#  define TN_PREEMPTIVE          1
+#endif
+
+
+/**
+ * Whether weighted fair-share scheduling is available for priority levels
+ * which have \ref round_robin "round-robin" enabled (see
+ * `tn_sys_tslice_set()`). Priority levels without time slice stay strict
+ * FIFO, as usual.
+ *
+ * Each task has a weight (see `tn_task_weight_set()`, default:
+ * `#TN_FAIR_SHARE_WEIGHT_DEF`) and a virtual run time, which grows on each
+ * system tick the task is running, by the value inversely proportional to
+ * the weight. When the time slice of the running task is over, the task is
+ * placed in the ready-to-run queue ordered by virtual run time (instead of
+ * just the tail of the queue), so the task which got the least CPU time
+ * relative to its weight runs next. For example, three busy tasks with
+ * weights 60, 30 and 10 get about 60%, 30% and 10% of CPU time left by
+ * higher-priority tasks.
+ *
+ * Tasks which become runnable after waiting don't get extra CPU time for
+ * the time they were waiting: their virtual run time is set to at least
+ * the one of the task at the head of the queue.
+ *
+ * Requires `#TN_PREEMPTIVE` and is not available in \ref
+ * time_ticks__dynamic_tick mode.
+ */
+#ifndef TN_FAIR_SHARE
+#  define TN_FAIR_SHARE          0
+#endif
+
+
+/**
+ * Whether task groups are available: see `struct #TN_TaskGroup`.
+ *
+ * Task group allows to suspend, resume or shift priority of all its member
+ * tasks at once, in one critical section and with a single scheduling
+ * decision (useful for switching between operating modes of the
+ * application).
+ *
+ * When it is non-zero, each task takes a list item and a pointer more.
+ */
+#ifndef TN_TASK_GROUPS
+#  define TN_TASK_GROUPS         0
+#endif
+
+
+/**
+ * Whether time partitioning is available: see `tn_sys_time_windows_set()`.
+ *
+ * Major frame of a fixed length is divided into time windows, and each
+ * window owns a set of task priorities: while the window is active, only
+ * tasks of those priorities (plus "always-on" priorities, typically the
+ * highest ones) are eligible to run, no matter how busy tasks of other
+ * priorities are. This way, overload in one partition can't eat time of
+ * another one.
+ *
+ * Windows are switched by the kernel timer, and the eligibility is applied
+ * as a mask on the ready-to-run bitmap, so that scheduling stays O(1).
+ *
+ * Requires `#TN_PREEMPTIVE`.
+ */
+#ifndef TN_TIME_PARTITIONS
+#  define TN_TIME_PARTITIONS     0
+#endif
+
+
+/**
+ * Whether table-driven time-triggered task release is available: see
+ * `tn_task_release_table_set()`.
+ *
+ * Static schedule table of `(offset, task)` entries over a hyperperiod is
+ * handled by a single kernel timer: at each offset, all tasks scheduled for
+ * it are released at once (activated, if they are dormant, or woken up, if
+ * they sleep in `tn_task_sleep()`), with a single scheduling decision.
+ * If the task isn't ready to be released (i.e. it is still doing the job of
+ * the previous release), this is reported as an overrun.
+ */
+#ifndef TN_TASK_RELEASE_TABLE
+#  define TN_TASK_RELEASE_TABLE  0
+#endif
+
+
+/**
+ * Whether the idle governor is available: see `tn_sys_sleep_states_set()`.
+ *
+ * Application registers a set of sleep states of the MCU (each one with
+ * its latency, break-even residency and relative power consumption), and
+ * the idle task picks the lowest-power state which doesn't violate the
+ * next kernel deadline (the nearest timer or timeout), enters it, accounts
+ * residency per state and, if the state stops the tick counter, compensates
+ * the system tick count on wake-up.
+ *
+ * Available in \ref time_ticks__dynamic_tick mode only: with static tick,
+ * the tick interrupt wakes the MCU each tick anyway.
+ */
+#ifndef TN_IDLE_GOVERNOR
+#  define TN_IDLE_GOVERNOR       0
+#endif
+
+
+/**
+ * Whether hybrid tick mode is available: see
+ * `tn_callback_tick_suppress_set()`.
+ *
+ * It is built on top of the \ref time_ticks__static_tick "static tick"
+ * timer engine: while some task is runnable, the tick is periodic. When the
+ * idle task runs, it finds the nearest timer expiration in the tick lists,
+ * lets the application stop the tick until then, and on wake-up adds the
+ * skipped ticks to the system tick count in one step. So, the system gets
+ * tickless power savings, while timer operations are as cheap as with
+ * static tick.
+ *
+ * Not available in \ref time_ticks__dynamic_tick mode, which is tickless
+ * by design.
+ */
+#ifndef TN_HYBRID_TICK
+#  define TN_HYBRID_TICK         0
+#endif
+
+
+/**
+ * Preemption points in the kernel loops whose length depends on the number
+ * of tasks or timers involved: notifying waiters of the deleted object,
+ * unlocking all mutexes held by the terminated task, and walking through the
+ * "generic" timer list.
+ *
+ * Waking up waiters of the event group has no preemption points: all the
+ * waiters should see the same flags pattern.
+ *
+ * If non-zero, these loops briefly enable interrupts after each
+ * `TN_PREEMPT_POINT_ITEMS` items handled, so that the worst-case interrupt
+ * latency doesn't depend on how many tasks or timers exist. Context switch
+ * is never allowed inside these windows: only interrupts may get in. If the
+ * kernel service is called with interrupts already disabled, they stay
+ * disabled.
+ *
+ * If zero, preemption points are disabled, and these loops run with
+ * interrupts disabled from start to end.
+ *
+ * \attention On Cortex-M0/M0+ the scheduler can't be disabled separately
+ * from other interrupts, so, in task context these windows aren't opened.
+ */
+#ifndef TN_PREEMPT_POINT_ITEMS
+#  define TN_PREEMPT_POINT_ITEMS 0
+#endif
+
+
+/**
+ * Whether the scheduling decision is made lazily.
+ *
+ * By default, the next task to run is looked for eagerly, on each change of
+ * the runnable state of some task. If kernel service or ISR changes the
+ * state of several tasks at once (say, event group wakes up a lot of
+ * waiting tasks), the search is repeated for each of them.
+ *
+ * If this option is non-zero, state changes only mark the scheduling
+ * decision as out of date, and the next task to run is looked for once:
+ * when the kernel checks whether context switch is needed, on exit from
+ * the critical section.
+ */
+#ifndef TN_LAZY_SCHED
+#  define TN_LAZY_SCHED          0
+#endif
+
+
+/**
+ * Whether the task wait timeout is cancelled lazily.
+ *
+ * By default, each wait with finite timeout starts the timer of the task,
+ * and each wakeup before the timeout cancels it: both are timer list
+ * operations.
+ *
+ * If this option is non-zero, wakeup before the timeout just marks the
+ * timer as stale, leaving it running; when stale timer fires, it does
+ * nothing. If task starts waiting again while its stale timer is still
+ * running, and that timer fires not later than the new timeout, the timer
+ * is reused as it is, and when it fires, it is just restarted for the rest
+ * of the timeout. So, if waits usually complete before their timeouts,
+ * the common block/wake path doesn't touch timer lists at all.
+ *
+ * The price is that stale timers still fire (in \ref
+ * time_ticks__dynamic_tick mode, they may wake the system up needlessly).
+ */
+#ifndef TN_LAZY_TIMEOUT
+#  define TN_LAZY_TIMEOUT        0
+#endif
+
+
+/**
+ * Whether the active objects framework is available: event-driven tasks
+ * with run-to-completion dispatch, publish-subscribe and time events, built
+ * on top of queues, memory pools and timers. Refer to the file tn_ao.h for
+ * details.
+ */
+#ifndef TN_ACTIVE_OBJECTS
+#  define TN_ACTIVE_OBJECTS      0
+#endif
+
+
+/**
+ * Whether asynchronous waits are available: `tn_sem_wait_async()`,
+ * `tn_queue_receive_async()` and `tn_fmem_get_async()` don't block the
+ * caller, but complete the wait later by calling the callback and/or
+ * putting the waiter node to the completion object. Refer to the file
+ * tn_async.h for details.
+ *
+ * Each semaphore, data queue and memory pool gets one more list head.
+ */
+#ifndef TN_ASYNC_WAIT
+#  define TN_ASYNC_WAIT          0
+#endif
+
+
+/**
+ * Whether the rate limiter (token bucket) object is available, see the file
+ * tn_ratelimit.h.
+ */
+#ifndef TN_RATE_LIMITER
+#  define TN_RATE_LIMITER        0
+#endif
+
+
+/**
+ * Whether selective receive from data queues is available: see
+ * `tn_queue_receive_match()`.
+ *
+ * Each data queue gets a pointer to the tag function, and each task gets
+ * a couple of words to store the tag it waits for.
+ */
+#ifndef TN_QUEUE_MATCH
+#  define TN_QUEUE_MATCH         0
+#endif
+
+
+/**
+ * Whether the recorder of interrupt-originated kernel calls is available,
+ * see the file tn_isrrec.h. When it's non-zero, each ISR kernel service
+ * (and the system tick) takes a few more cycles to check whether some
+ * recorder is running.
+ */
+#ifndef TN_ISR_RECORD
+#  define TN_ISR_RECORD          0
+#endif
+
+
+/**
+ * Whether the timer engine collects statistics which helps to choose
+ * `#TN_TICK_LISTS_CNT`: number of timers started, how many of them go to
+ * the "generic" list, cascading, list lengths, time spent in callbacks and
+ * the histogram of timeouts. See `tn_timer_stat_get()`.
+ *
+ * When it's non-zero, starting a timer and the system tick processing take
+ * a few more cycles.
+ */
+#ifndef TN_TIMER_STAT
+#  define TN_TIMER_STAT          0
+#endif
+
+
+/**
+ * Whether unchecked variants of the most frequently used services are
+ * available: `tn_sem_signal_fast()`, `tn_sem_wait_fast()`,
+ * `tn_queue_send_fast()` and `tn_queue_receive_fast()`. They don't check
+ * parameters and context regardless of `#TN_CHECK_PARAM` (with `#TN_DEBUG`,
+ * they still check them by `_TN_BUG_ON()`), so they can be used in the
+ * hot paths while the rest of the application keeps full checking.
+ */
+#ifndef TN_FAST_API
+#  define TN_FAST_API            0
+#endif
+
+
 /**
  * Whether the old TNKernel events API compatibility mode is active.
  *
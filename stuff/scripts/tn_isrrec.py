@@ -0,0 +1,432 @@
+#!/usr/bin/env python3
+#
+# TNeo: host tool for the recordings of ISR kernel calls (`TN_ISR_RECORD`)
+#
+# Input is the dump of recorded entries (`struct TN_IsrRecEntry`) in
+# chronological order, as they are returned by `tn_isrrec_entry_get()` from
+# 0 to `tn_isrrec_entries_cnt_get() - 1`. The dump is either a raw binary
+# file (for example, dumped by the debugger, or sent byte-by-byte via UART),
+# or a text file with hex bytes (whitespace is ignored).
+#
+# Commands:
+#
+#  - `show`: print the timeline (timestamp, delta from the previous entry,
+#    call, object, argument and returned code), and the per-object
+#    statistics of intervals between calls;
+#  - `diff`: compare two recordings (say, recorded by two firmware versions
+#    while replaying the same stimulus) and report the first divergence of
+#    calls or returned codes, as well as the largest timing difference;
+#  - `gen`: generate C source of the replay harness: the table of entries
+#    with addresses resolved to symbols of the image being tested, and the
+#    driver which replays them by `tn_isrrec_replay()` in the virtual time.
+#
+# Addresses are resolved to symbols with the output of `nm -S` (or plain
+# `nm`) for the image which has made the recording (`--syms`), and,
+# for `gen`, symbols are looked up by name in the image which replays.
+# Static objects can't be referred to by the generated source: their raw
+# addresses are used, with a warning.
+#
+# Usage example (Cortex-M, GNU toolchain):
+#
+#    $ arm-none-eabi-nm -S app.elf > app.sym
+#    $ python3 tn_isrrec.py show --word-size 4 --syms app.sym rec.bin
+#    $ python3 tn_isrrec.py gen --word-size 4 --syms app.sym rec.bin \
+#          -o isrrec_replay.c
+#    $ python3 tn_isrrec.py diff --word-size 4 rec.bin replayed.bin
+#
+# The generated harness is used as follows: the replay interrupt (a timer
+# interrupt, or a software-triggered one in the simulator) calls
+# `<prefix>_step()`, which sets the virtual time to the timestamp of the next
+# entry and replays it; `<prefix>_next_delta_get()` tells when the next
+# interrupt should happen. If the recorder is running during replay, give
+# `<prefix>_time()` to `tn_isrrec_create()` as the timestamp function, so
+# that the new recording is comparable with the original one.
+#
+# Exit status of `diff` is 1 if recordings diverge, or 0 otherwise.
+#
+
+import argparse
+import bisect
+import re
+import struct
+import sys
+
+
+#-- Values of `enum TN_IsrRecCall`: (name, object type, meaning of `arg`,
+#   meaning of `arg2`). Order matters: it's the value of `call`.
+CALLS = [
+   ('TICK',                   None,          None,        None),
+   ('SEM_ISIGNAL',            'TN_Sem',      None,        None),
+   ('SEM_IWAIT_POLLING',      'TN_Sem',      None,        None),
+   ('QUEUE_ISEND_POLLING',    'TN_DQueue',   'data',      None),
+   ('QUEUE_IRECEIVE_POLLING', 'TN_DQueue',   'data',      None),
+   ('EVENTGRP_IMODIFY',       'TN_EventGrp', 'pattern',   'op'),
+   ('EVENTGRP_IWAIT_POLLING', 'TN_EventGrp', 'pattern',   'wmode'),
+   ('FMEM_IGET_POLLING',      'TN_FMem',     'data',      None),
+   ('FMEM_IRELEASE',          'TN_FMem',     'data',      None),
+   ('TASK_IWAKEUP',           'TN_Task',     None,        None),
+   ('TASK_IACTIVATE',         'TN_Task',     None,        None),
+   ('TASK_IRELEASE_WAIT',     'TN_Task',     None,        None),
+]
+
+#-- Values of `enum TN_RCode`
+RCODES = {
+   0: 'OK', -1: 'TIMEOUT', -2: 'OVERFLOW', -3: 'WCONTEXT', -4: 'WSTATE',
+   -5: 'WPARAM', -6: 'ILLEGAL_USE', -7: 'INVALID_OBJ', -8: 'DELETED',
+   -9: 'FORCED', -10: 'INTERNAL',
+}
+
+#-- Values of `enum TN_EGrpOp`
+EGRP_OPS = {0: 'SET', 1: 'CLEAR', 2: 'TOGGLE'}
+
+
+def warn(msg):
+   sys.stderr.write('warning: %s\n' % msg)
+
+
+class Entry:
+   def __init__(self, time, obj, arg, call, arg2, rc):
+      self.time = time
+      self.obj = obj
+      self.arg = arg
+      self.call = call
+      self.arg2 = arg2
+      self.rc = rc
+
+   def key(self):
+      """Everything but the timestamp: what must match on replay"""
+      return (self.call, self.obj, self.arg, self.arg2, self.rc)
+
+
+def entry_size(word_size):
+   #-- three words (time, obj, arg) and three chars, padded to the word
+   size = word_size * 3 + 3
+   return (size + word_size - 1) // word_size * word_size
+
+
+def read_dump(path, word_size, endian):
+   with open(path, 'rb') as f:
+      data = f.read()
+
+   #-- text dump with hex bytes?
+   try:
+      text = data.decode('ascii')
+      if re.fullmatch(r'[0-9a-fA-F\s]*', text) and text.strip():
+         data = bytes.fromhex(''.join(text.split()))
+   except UnicodeDecodeError:
+      pass
+
+   size = entry_size(word_size)
+   if len(data) % size:
+      warn('%s: size %d is not a multiple of entry size %d, tail ignored'
+            % (path, len(data), size))
+
+   wfmt = {2: 'H', 4: 'I', 8: 'Q'}[word_size]
+   fmt = ('<' if endian == 'little' else '>') + wfmt * 3 + 'BBb'
+   entries = []
+   for ofs in range(0, len(data) - size + 1, size):
+      entries.append(Entry(*struct.unpack_from(fmt, data, ofs)))
+
+   return entries
+
+
+class Symbols:
+   """Address-to-symbol map, built from `nm -S` or `nm` output"""
+
+   def __init__(self, path):
+      self.addrs = []
+      self.syms = []    # (addr, size, name, is_global)
+      if path is None:
+         return
+
+      with open(path) as f:
+         for line in f:
+            fields = line.split()
+            if len(fields) == 4:
+               addr, size, kind, name = fields
+               size = int(size, 16)
+            elif len(fields) == 3:
+               addr, kind, name = fields
+               size = 0
+            else:
+               continue
+            if kind.upper() not in 'BDRGSVC':
+               continue
+            self.syms.append((int(addr, 16), size, name, kind.isupper()))
+
+      self.syms.sort()
+      self.addrs = [s[0] for s in self.syms]
+
+   def lookup(self, addr):
+      """Returns (name, offset, is_global) or None"""
+      i = bisect.bisect_right(self.addrs, addr) - 1
+      if i >= 0:
+         saddr, size, name, is_global = self.syms[i]
+         if addr == saddr or addr < saddr + size:
+            return (name, addr - saddr, is_global)
+      return None
+
+   def fmt(self, addr):
+      sym = self.lookup(addr) if addr else None
+      if sym is None:
+         return '0x%x' % addr
+      name, ofs, _ = sym
+      return name if ofs == 0 else '%s+%d' % (name, ofs)
+
+
+def call_name(call):
+   return CALLS[call][0] if call < len(CALLS) else 'UNKNOWN_%d' % call
+
+
+def rc_name(rc):
+   return RCODES.get(rc, str(rc))
+
+
+def entry_fmt(e, syms):
+   items = [call_name(e.call)]
+   if e.call < len(CALLS):
+      _, obj_type, arg_kind, arg2_kind = CALLS[e.call]
+      if obj_type:
+         items.append(syms.fmt(e.obj))
+      if arg_kind == 'data':
+         items.append('data=%s' % syms.fmt(e.arg))
+      elif arg_kind == 'pattern':
+         items.append('pattern=0x%x' % e.arg)
+      if arg2_kind == 'op':
+         items.append('op=%s' % EGRP_OPS.get(e.arg2, e.arg2))
+      elif arg2_kind == 'wmode':
+         items.append('wmode=0x%x' % e.arg2)
+   items.append(rc_name(e.rc))
+   return ' '.join(items)
+
+
+def time_delta(t1, t0, word_size):
+   return (t1 - t0) & ((1 << (word_size * 8)) - 1)
+
+
+def cmd_show(args):
+   syms = Symbols(args.syms)
+   entries = read_dump(args.dump, args.word_size, args.endian)
+
+   print('%8s %12s %10s  %s' % ('#', 'time', 'delta', 'call'))
+   prev = None
+   for i, e in enumerate(entries):
+      delta = time_delta(e.time, prev.time, args.word_size) if prev else 0
+      print('%8d %12d %10d  %s' % (i, e.time, delta, entry_fmt(e, syms)))
+      prev = e
+
+   #-- intervals between calls of the same kind on the same object
+   stat = {}
+   last = {}
+   for e in entries:
+      k = (e.call, e.obj)
+      s = stat.setdefault(k, [0, None, None, 0])
+      s[0] += 1
+      if k in last:
+         d = time_delta(e.time, last[k], args.word_size)
+         s[1] = d if s[1] is None else min(s[1], d)
+         s[2] = d if s[2] is None else max(s[2], d)
+         s[3] += d
+      last[k] = e.time
+
+   print('')
+   print('%-24s %-24s %8s %10s %10s %10s'
+         % ('call', 'object', 'count', 'min', 'avg', 'max'))
+   for (call, obj), (cnt, dmin, dmax, dsum) in sorted(
+         stat.items(), key=lambda kv: -kv[1][0]):
+      avg = dsum // (cnt - 1) if cnt > 1 else None
+      print('%-24s %-24s %8d %10s %10s %10s' % (
+         call_name(call), syms.fmt(obj) if obj else '-', cnt,
+         '-' if dmin is None else dmin,
+         '-' if avg is None else avg,
+         '-' if dmax is None else dmax))
+
+   return 0
+
+
+def cmd_diff(args):
+   syms = Symbols(args.syms)
+   a = read_dump(args.dump_a, args.word_size, args.endian)
+   b = read_dump(args.dump_b, args.word_size, args.endian)
+
+   ret = 0
+   for i, (ea, eb) in enumerate(zip(a, b)):
+      if ea.key() != eb.key():
+         print('first divergence at entry %d:' % i)
+         print('   a: %s' % entry_fmt(ea, syms))
+         print('   b: %s' % entry_fmt(eb, syms))
+         ret = 1
+         break
+   else:
+      if len(a) != len(b):
+         print('recordings have different lengths: %d and %d'
+               % (len(a), len(b)))
+         ret = 1
+      else:
+         print('calls and returned codes match (%d entries)' % len(a))
+
+   #-- timing: compare times relative to the first entry
+   n = min(len(a), len(b))
+   if n and ret == 0:
+      worst = max(range(n), key=lambda i: abs(
+         time_delta(a[i].time, a[0].time, args.word_size)
+         - time_delta(b[i].time, b[0].time, args.word_size)))
+      print('largest timing difference at entry %d (%s): %d' % (
+         worst, entry_fmt(a[worst], syms),
+         time_delta(b[worst].time, b[0].time, args.word_size)
+         - time_delta(a[worst].time, a[0].time, args.word_size)))
+
+   return ret
+
+
+def cmd_gen(args):
+   syms = Symbols(args.syms)
+   entries = read_dump(args.dump, args.word_size, args.endian)
+   prefix = args.prefix
+   externs = set()
+   raw = set()
+
+   def addr_expr(addr, kind):
+      sym = syms.lookup(addr) if addr else None
+      if sym is not None and sym[2]:
+         name, ofs, _ = sym
+         externs.add(name)
+         return '(%s)(%s + %d)' % (kind, name, ofs)
+      if addr and addr not in raw:
+         raw.add(addr)
+         warn('address 0x%x is not resolved to a global symbol, '
+               'raw value is used' % addr)
+      return '(%s)0x%xu' % (kind, addr)
+
+   rows = []
+   for e in entries:
+      if e.call >= len(CALLS):
+         warn('unknown call %d skipped' % e.call)
+         continue
+      _, obj_type, arg_kind, _ = CALLS[e.call]
+      obj = addr_expr(e.obj, 'void *') if obj_type else 'TN_NULL'
+      arg = addr_expr(e.arg, 'TN_UWord') if arg_kind == 'data' \
+            else '0x%xu' % e.arg
+      rows.append('   { %du, %s, %s, TN_ISRREC_CALL_%s, %d, %d },' % (
+         e.time, obj, arg, call_name(e.call), e.arg2, e.rc))
+
+   out = []
+   out.append('/*')
+   out.append(' * Replay harness generated by tn_isrrec.py from %s' % args.dump)
+   out.append(' * DO NOT EDIT')
+   out.append(' */')
+   out.append('')
+   out.append('#include "tn.h"')
+   out.append('')
+   for name in sorted(externs):
+      out.append('extern char %s[];' % name)
+   out.append('')
+   out.append('const struct TN_IsrRecEntry %s_entries[] = {' % prefix)
+   out.extend(rows)
+   out.append('};')
+   out.append('')
+   out.append('const int %s_entries_cnt = %d;' % (prefix, len(rows)))
+   out.append('')
+   out.append('/// number of replayed entries which returned other codes')
+   out.append('volatile int %s_mismatch_cnt = 0;' % prefix)
+   out.append('')
+   out.append('/// virtual time: timestamp of the entry being replayed')
+   out.append('volatile TN_UWord %s_vtime = 0;' % prefix)
+   out.append('')
+   out.append('static volatile int _next_idx = 0;')
+   out.append('')
+   out.append('/**')
+   out.append(' * Timestamp function for `tn_isrrec_create()`, for recording')
+   out.append(' * during replay')
+   out.append(' */')
+   out.append('TN_UWord %s_time(void)' % prefix)
+   out.append('{')
+   out.append('   return %s_vtime;' % prefix)
+   out.append('}')
+   out.append('')
+   out.append('/**')
+   out.append(' * Replay the next entry; should be called from the replay')
+   out.append(' * interrupt. Returns `TN_FALSE` when all entries are replayed.')
+   out.append(' */')
+   out.append('TN_BOOL %s_step(void)' % prefix)
+   out.append('{')
+   out.append('   TN_BOOL ret = TN_FALSE;')
+   out.append('')
+   out.append('   if (_next_idx < %s_entries_cnt){' % prefix)
+   out.append('      const struct TN_IsrRecEntry *entry')
+   out.append('         = &%s_entries[_next_idx++];' % prefix)
+   out.append('')
+   out.append('      %s_vtime = entry->time;' % prefix)
+   out.append('      if (tn_isrrec_replay(entry) != (enum TN_RCode)entry->rc){')
+   out.append('         %s_mismatch_cnt++;' % prefix)
+   out.append('      }')
+   out.append('      ret = TN_TRUE;')
+   out.append('   }')
+   out.append('')
+   out.append('   return ret;')
+   out.append('}')
+   out.append('')
+   out.append('/**')
+   out.append(' * Returns time from the last replayed entry to the next one,')
+   out.append(' * or 0 if there are no more entries.')
+   out.append(' */')
+   out.append('TN_UWord %s_next_delta_get(void)' % prefix)
+   out.append('{')
+   out.append('   TN_UWord ret = 0;')
+   out.append('')
+   out.append('   if (_next_idx < %s_entries_cnt && _next_idx > 0){' % prefix)
+   out.append('      ret = %s_entries[_next_idx].time' % prefix)
+   out.append('         - %s_entries[_next_idx - 1].time;' % prefix)
+   out.append('   }')
+   out.append('')
+   out.append('   return ret;')
+   out.append('}')
+   out.append('')
+
+   text = '\n'.join(out)
+   if args.output:
+      with open(args.output, 'w') as f:
+         f.write(text)
+   else:
+      sys.stdout.write(text)
+
+   return 0
+
+
+def main():
+   p = argparse.ArgumentParser(
+         description='Show, compare and replay recordings of ISR kernel calls')
+   common = argparse.ArgumentParser(add_help=False)
+   common.add_argument('--word-size', type=int, choices=[2, 4, 8], default=4,
+         help='size of TN_UWord and pointers on the target, in bytes')
+   common.add_argument('--endian', choices=['little', 'big'],
+         default='little', help='byte order on the target')
+   common.add_argument('--syms', help='output of `nm -S` for the image')
+
+   sub = p.add_subparsers(dest='cmd')
+   sub.required = True
+
+   ps = sub.add_parser('show', parents=[common], help='print the timeline')
+   ps.add_argument('dump')
+   ps.set_defaults(func=cmd_show)
+
+   pd = sub.add_parser('diff', parents=[common],
+         help='compare two recordings')
+   pd.add_argument('dump_a')
+   pd.add_argument('dump_b')
+   pd.set_defaults(func=cmd_diff)
+
+   pg = sub.add_parser('gen', parents=[common],
+         help='generate C source of the replay harness')
+   pg.add_argument('dump')
+   pg.add_argument('-o', '--output', help='output file (default: stdout)')
+   pg.add_argument('--prefix', default='isrrec_replay',
+         help='prefix of generated symbols')
+   pg.set_defaults(func=cmd_gen)
+
+   args = p.parse_args()
+   return args.func(args)
+
+
+if __name__ == '__main__':
+   sys.exit(main())
@@ -0,0 +1,570 @@
+#!/usr/bin/env python3
+#
+# TNeo: worst-case task stack usage estimator
+#
+# Computes worst-case stack usage of each task body given to
+# `tn_task_create()` / `tn_task_create_wname()`, and compares it with the size
+# of the stack array given to the kernel (usually declared with
+# `TN_STACK_ARR_DEF()`).
+#
+# Inputs:
+#
+#  - `.su` files generated by GCC/Clang with `-fstack-usage`; the kernel
+#    sources should be built with this flag too, so that the depth of kernel
+#    services called by tasks is taken into account;
+#  - call graph: either `.ci` files generated by GCC with `-fcallgraph-info`,
+#    or the disassembly of the built image (`objdump -d`);
+#  - application sources, which are scanned for `tn_task_create()` calls,
+#    `TN_STACK_ARR_DEF()` definitions and `#define`-d stack sizes. Instead
+#    (or in addition), tasks can be given explicitly with `--task`.
+#
+# Required stack size of the task, in words, is:
+#
+#    ceil(worst_path_bytes / word_size) + context_frame + overflow_check_word
+#
+# where `context_frame` is the size of the context saved on the task stack by
+# the kernel (it's the same frame which is initially built by
+# `_tn_arch_stack_init()`), and `overflow_check_word` is 1 if
+# `TN_STACK_OVERFLOW_CHECK` is non-zero.
+#
+# Usage example (Cortex-M3, GNU toolchain):
+#
+#    $ make CFLAGS+="-fstack-usage -fcallgraph-info" ...
+#    $ python3 tn_stack_usage.py --arch cortex_m \
+#          --su-dir _obj --ci-dir _obj --src app/src
+#
+#    $ arm-none-eabi-objdump -d app.elf > app.dis
+#    $ python3 tn_stack_usage.py --arch cortex_m \
+#          --su-dir _obj --objdump app.dis --src app/src --path
+#
+# Exit status is 1 if some task is under-provisioned, or 0 otherwise.
+#
+
+import argparse
+import math
+import os
+import re
+import subprocess
+import sys
+
+
+#-- Architecture-specific data:
+#   (word size in bytes, context frame size in words)
+#
+#   Context frame sizes match the ones used by `TN_MIN_STACK_SIZE` in the
+#   arch headers (without the overflow check word).
+ARCHS = {
+   'cortex_m':       (4, 17),
+   'cortex_m_fpu':   (4, 17 + 32),
+   'pic32':          (4, 36),
+   'pic24':          (2, 25),
+   'pic24_eds':      (2, 26),
+}
+
+#-- Mnemonics of call instructions for all supported architectures
+CALL_MNEMONICS = {
+   'bl', 'blx', 'jal', 'jalx', 'call', 'callq', 'rcall',
+}
+
+#-- Mnemonics of unconditional jumps which may be tail calls
+JUMP_MNEMONICS = {
+   'b', 'b.w', 'b.n', 'j', 'goto', 'bra', 'jmp', 'jmpq',
+}
+
+#-- Regexps for indirect calls: `blx r3`, `jalr t9`, `call w0`
+INDIRECT_CALL_RE = re.compile(
+      r'^\s*(blx\s+r\d+|blx\s+(ip|lr)|jalr\b|call\s+w\d+|rcall\s+w\d+)'
+      )
+
+#-- Name used by `-fcallgraph-info` for indirect calls
+CI_INDIRECT = '__indirect_call'
+
+
+def warn(msg):
+   sys.stderr.write('warning: %s\n' % msg)
+
+
+#-- Stack usage data {{{
+
+def parse_su_file(path, stack):
+   """
+   Parse one `.su` file, each line looks like:
+
+      tn_tasks.c:412:16:tn_task_create   48   static
+
+   Qualifier can also be `dynamic` or `dynamic,bounded`.
+   """
+   with open(path) as f:
+      for line in f:
+         line = line.rstrip('\n')
+         if not line:
+            continue
+         parts = line.split('\t')
+         if len(parts) < 3:
+            warn('%s: malformed line: %s' % (path, line))
+            continue
+
+         name = parts[0].rsplit(':', 1)[-1]
+         #-- C++ names contain signature; use plain name before '('
+         name = name.split('(')[0].strip()
+         size = int(parts[1])
+         qual = parts[2].strip()
+
+         prev = stack.get(name)
+         if prev is not None and prev[0] != size:
+            #-- static functions with the same name in different units:
+            #   be conservative and take the maximum
+            size = max(size, prev[0])
+         stack[name] = (size, qual)
+
+
+def collect_files(dirs, files, ext):
+   ret = list(files or [])
+   for d in dirs or []:
+      for root, _, names in os.walk(d):
+         for n in sorted(names):
+            if n.endswith(ext):
+               ret.append(os.path.join(root, n))
+   return ret
+
+# }}}
+
+#-- Call graph {{{
+
+def graph_add(graph, caller, callee):
+   graph.setdefault(caller, set()).add(callee)
+
+
+def parse_ci_file(path, graph, indirect):
+   """
+   Parse one VCG file generated by `-fcallgraph-info`; we need edges only.
+   """
+   with open(path) as f:
+      text = f.read()
+
+   for m in re.finditer(
+         r'edge:\s*{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"',
+         text
+         ):
+      caller = m.group(1).rsplit(':', 1)[-1]
+      callee = m.group(2).rsplit(':', 1)[-1]
+      if callee == CI_INDIRECT:
+         indirect.add(caller)
+      else:
+         graph_add(graph, caller, callee)
+
+
+def parse_objdump(lines, graph, indirect):
+   """
+   Parse output of `objdump -d` (or `objdump -dr`, for relocatable objects).
+   """
+   func_re = re.compile(r'^[0-9a-fA-F]+\s+<([^>]+)>:\s*$')
+   insn_re = re.compile(
+         r'^\s*[0-9a-fA-F]+:\s+(?:[0-9a-fA-F]{2,8}\s)+\s*([a-z][\w.]*)\s+(.*)$'
+         )
+   reloc_re = re.compile(r'^\s*[0-9a-fA-F]+:\s+R_\w+\s+([A-Za-z_.$][\w.$]*)')
+   target_re = re.compile(r'<([^>+]+)(\+0x[0-9a-fA-F]+)?>')
+
+   cur = None
+   last_mnem = None
+   for line in lines:
+      m = func_re.match(line)
+      if m:
+         cur = m.group(1)
+         last_mnem = None
+         continue
+      if cur is None:
+         continue
+
+      m = reloc_re.match(line)
+      if m:
+         #-- relocation of the previous instruction: in relocatable objects,
+         #   this is the only way to know the callee
+         if last_mnem in CALL_MNEMONICS or last_mnem in JUMP_MNEMONICS:
+            if m.group(1) != cur and not m.group(1).startswith('.'):
+               graph_add(graph, cur, m.group(1))
+         last_mnem = None
+         continue
+
+      m = insn_re.match(line)
+      if not m:
+         continue
+
+      mnem, operands = m.group(1), m.group(2)
+      last_mnem = mnem
+
+      if INDIRECT_CALL_RE.match('%s %s' % (mnem, operands)):
+         indirect.add(cur)
+         continue
+
+      t = target_re.search(operands)
+      if not t:
+         continue
+      target, offset = t.group(1), t.group(2)
+
+      if offset is not None or target == cur:
+         #-- not a function entry: either a local jump, or unresolved
+         #   target (relocation will follow, if any)
+         continue
+
+      if mnem in CALL_MNEMONICS or mnem in JUMP_MNEMONICS:
+         #-- jump to the beginning of another function is a tail call
+         graph_add(graph, cur, target)
+
+# }}}
+
+#-- Application sources scanning {{{
+
+def strip_comments(text):
+   text = re.sub(r'/\*.*?\*/', lambda m: '\n' * m.group(0).count('\n'),
+                 text, flags=re.S)
+   return re.sub(r'//[^\n]*', '', text)
+
+
+def split_args(text, start):
+   """
+   Given `text` and index right after the opening parenthesis, return list of
+   top-level arguments and index after the closing parenthesis.
+   """
+   depth = 0
+   args = []
+   cur = ''
+   i = start
+   while i < len(text):
+      c = text[i]
+      if c in '([{':
+         depth += 1
+      elif c in ')]}':
+         if depth == 0:
+            args.append(cur.strip())
+            return args, i + 1
+         depth -= 1
+      elif c == ',' and depth == 0:
+         args.append(cur.strip())
+         cur = ''
+         i += 1
+         continue
+      cur += c
+      i += 1
+   return None, i
+
+
+class Sources:
+
+   def __init__(self):
+      self.defines = {}
+      self.stack_arrays = {}
+      self.tasks = []
+
+   def scan(self, path):
+      with open(path, errors='replace') as f:
+         text = strip_comments(f.read())
+
+      #-- join continuation lines
+      text = re.sub(r'\\\n', ' ', text)
+
+      for m in re.finditer(
+            r'^[ \t]*#[ \t]*define[ \t]+([A-Za-z_]\w*)(?![\w(])[ \t]*(.*)$',
+            text, flags=re.M
+            ):
+         self.defines.setdefault(m.group(1), m.group(2).strip())
+
+      for m in re.finditer(r'\bTN_(?:STACK_ARR|TASK_STACK)_DEF\s*\(', text):
+         args, _ = split_args(text, m.end())
+         if args and len(args) == 2:
+            self.stack_arrays[args[0]] = args[1]
+
+      for m in re.finditer(r'(?<![\w.>])tn_task_create(_wname)?\s*\(', text):
+         args, _ = split_args(text, m.end())
+         if not args or len(args) < 7:
+            continue
+
+         body = re.sub(r'^\((\s*TN_TaskBody\s*\*\s*)\)', '', args[1])
+         body = body.lstrip('&').strip()
+         if not re.match(r'^[A-Za-z_]\w*$', body):
+            #-- probably a declaration, not a call
+            continue
+
+         stack_arr = re.sub(r'^&\s*|\s*\[\s*0\s*\]$', '', args[3]).strip()
+         line = text.count('\n', 0, m.start()) + 1
+
+         self.tasks.append({
+            'body': body,
+            'size_expr': args[4],
+            'stack_arr': stack_arr,
+            'where': '%s:%d' % (path, line),
+            })
+
+   def eval_expr(self, expr, depth=0):
+      """
+      Evaluate integer constant expression, expanding macros known so far.
+      Returns None if the expression can't be evaluated.
+      """
+      if depth > 32:
+         return None
+
+      def repl(m):
+         name = m.group(0)
+         if name in self.defines:
+            val = self.eval_expr(self.defines[name], depth + 1)
+            if val is not None:
+               return '(%d)' % val
+         raise KeyError(name)
+
+      #-- drop integer suffixes and casts to plain types
+      expr = re.sub(r'\b(0[xX][0-9a-fA-F]+|\d+)[uUlL]+\b', r'\1', expr)
+      expr = re.sub(
+            r'\(\s*(unsigned|signed|int|long|short|TN_UWord|size_t)'
+            r'(\s+(int|long))*\s*\)', '', expr
+            )
+
+      try:
+         expr = re.sub(r'\b[A-Za-z_]\w*\b', repl, expr)
+      except KeyError:
+         return None
+
+      if not re.match(r'^[\s\d()+\-*/%<>&|^~xXa-fA-F]*$', expr):
+         return None
+
+      try:
+         return int(eval(expr.replace('/', '//'), {'__builtins__': {}}))
+      except Exception:
+         return None
+
+# }}}
+
+#-- Worst-case stack computation {{{
+
+class Analyzer:
+
+   def __init__(self, stack, graph, indirect, assumed):
+      self.stack = stack
+      self.graph = graph
+      self.indirect = indirect
+      self.assumed = assumed
+      self.memo = {}
+      self.unknown = set()
+      self.recursive = set()
+      self.dynamic = set()
+
+   def frame(self, func):
+      if func in self.assumed:
+         return self.assumed[func]
+      if func in self.stack:
+         size, qual = self.stack[func]
+         if qual.startswith('dynamic') and qual != 'dynamic,bounded':
+            self.dynamic.add(func)
+         return size
+      self.unknown.add(func)
+      return 0
+
+   def worst(self, func, on_path=None):
+      """
+      Returns tuple: (worst-case bytes, worst path as list of functions,
+      set of problems found on all paths).
+      """
+      if func in self.memo:
+         return self.memo[func]
+
+      on_path = on_path or []
+      if func in on_path:
+         cycle = on_path[on_path.index(func):] + [func]
+         self.recursive.add(' -> '.join(cycle))
+         return (0, [func], {'recursion'})
+
+      on_path = on_path + [func]
+      own = self.frame(func)
+
+      problems = set()
+      if func in self.unknown:
+         problems.add('unknown: %s' % func)
+      if func in self.dynamic:
+         problems.add('dynamic: %s' % func)
+      if func in self.indirect:
+         problems.add('indirect calls: %s' % func)
+
+      best = (0, [])
+      for callee in sorted(self.graph.get(func, ())):
+         size, path, callee_problems = self.worst(callee, on_path)
+         problems |= callee_problems
+         if size > best[0] or not best[1]:
+            best = (size, path)
+
+      ret = (own + best[0], [func] + best[1], problems)
+      if 'recursion' not in problems:
+         self.memo[func] = ret
+      return ret
+
+# }}}
+
+
+def parse_kv(items, what):
+   ret = {}
+   for item in items or []:
+      if '=' not in item:
+         sys.exit('error: wrong %s: "%s", NAME=VALUE expected' % (what, item))
+      k, v = item.split('=', 1)
+      ret[k.strip()] = v.strip()
+   return ret
+
+
+def main():
+   p = argparse.ArgumentParser(
+         description='Estimate worst-case stack usage of TNeo tasks.'
+         )
+   p.add_argument('--arch', choices=sorted(ARCHS), required=True,
+                  help='target architecture')
+   p.add_argument('--ctx-frame', type=int,
+                  help='override size of the context frame, in words')
+   p.add_argument('--no-overflow-check', action='store_true',
+                  help='TN_STACK_OVERFLOW_CHECK is zero '
+                       '(default for pic24 archs)')
+   p.add_argument('--su', action='append', help='.su file')
+   p.add_argument('--su-dir', action='append',
+                  help='directory to search for .su files recursively')
+   p.add_argument('--ci', action='append', help='.ci file')
+   p.add_argument('--ci-dir', action='append',
+                  help='directory to search for .ci files recursively')
+   p.add_argument('--objdump', action='append',
+                  help='file with output of `objdump -d`')
+   p.add_argument('--elf', help='image to disassemble with --objdump-cmd')
+   p.add_argument('--objdump-cmd', default='objdump',
+                  help='objdump executable for --elf (default: objdump)')
+   p.add_argument('--src', action='append',
+                  help='application source file or directory to scan '
+                       'for tn_task_create() calls')
+   p.add_argument('-D', dest='defines', action='append', metavar='NAME=VAL',
+                  help='define macro used in stack size expressions')
+   p.add_argument('--task', action='append', metavar='BODY=WORDS',
+                  help='task body and its stack size in words')
+   p.add_argument('--call', action='append', metavar='CALLER=CALLEE[,..]',
+                  help='add call graph edges, e.g. for indirect calls')
+   p.add_argument('--assume', action='append', metavar='FUNC=BYTES',
+                  help='stack usage of function without .su data (asm, libs)')
+   p.add_argument('--margin', type=int, default=10,
+                  help='recommended reserve, percent (default: 10)')
+   p.add_argument('--over', type=float, default=1.5,
+                  help='report task as over-provisioned if its stack is '
+                       'larger than recommended size multiplied by this '
+                       'value (default: 1.5)')
+   p.add_argument('--path', action='store_true',
+                  help='print worst-case call chain for each task')
+   args = p.parse_args()
+
+   word, ctx_words = ARCHS[args.arch]
+   if args.ctx_frame is not None:
+      ctx_words = args.ctx_frame
+   overflow_word = 0 if (args.no_overflow_check
+                         or args.arch.startswith('pic24')) else 1
+
+   #-- stack usage of each function
+   stack = {}
+   su_files = collect_files(args.su_dir, args.su, '.su')
+   if not su_files:
+      sys.exit('error: no .su files given')
+   for path in su_files:
+      parse_su_file(path, stack)
+
+   #-- call graph
+   graph = {}
+   indirect = set()
+   for path in collect_files(args.ci_dir, args.ci, '.ci'):
+      parse_ci_file(path, graph, indirect)
+   for path in args.objdump or []:
+      with open(path, errors='replace') as f:
+         parse_objdump(f, graph, indirect)
+   if args.elf:
+      out = subprocess.run(
+            [args.objdump_cmd, '-d', args.elf],
+            check=True, stdout=subprocess.PIPE, universal_newlines=True
+            ).stdout
+      parse_objdump(out.splitlines(), graph, indirect)
+   if not graph:
+      warn('call graph is empty: give --ci, --objdump or --elf')
+
+   for caller, callees in parse_kv(args.call, '--call').items():
+      for callee in callees.split(','):
+         graph_add(graph, caller, callee.strip())
+      #-- indirect calls of this function are resolved by the user
+      indirect.discard(caller)
+
+   assumed = {k: int(v) for k, v in parse_kv(args.assume, '--assume').items()}
+
+   #-- tasks
+   src = Sources()
+   src.defines.update(parse_kv(args.defines, '-D'))
+   src.defines.setdefault('_TN_STACK_OVERFLOW_SIZE_ADD', str(overflow_word))
+   src.defines.setdefault('TN_MIN_STACK_SIZE', str(ctx_words + overflow_word))
+
+   for path in collect_files(
+         [s for s in args.src or [] if os.path.isdir(s)],
+         [s for s in args.src or [] if not os.path.isdir(s)],
+         '.c'
+         ):
+      src.scan(path)
+   #-- headers may contain stack size definitions as well
+   for path in collect_files(
+         [s for s in args.src or [] if os.path.isdir(s)], [], '.h'
+         ):
+      src.scan(path)
+
+   tasks = list(src.tasks)
+   for body, words in parse_kv(args.task, '--task').items():
+      tasks.append({
+         'body': body, 'size_expr': words, 'stack_arr': '',
+         'where': 'command line',
+         })
+
+   if not tasks:
+      sys.exit('error: no tasks found')
+
+   analyzer = Analyzer(stack, graph, indirect, assumed)
+
+   fmt = '%-28s %9s %9s %9s  %s'
+   print(fmt % ('task body', 'declared', 'required', 'recommend', 'status'))
+   print(fmt % ('', '(words)', '(words)', '(words)', ''))
+
+   under = False
+   for task in tasks:
+      declared = src.eval_expr(task['size_expr'])
+      if declared is None and task['stack_arr'] in src.stack_arrays:
+         declared = src.eval_expr(src.stack_arrays[task['stack_arr']])
+
+      size, path, problems = analyzer.worst(task['body'])
+      required = int(math.ceil(size / float(word))) + ctx_words + overflow_word
+      recommended = int(math.ceil(required * (100 + args.margin) / 100.0))
+
+      if declared is None:
+         status = 'UNKNOWN SIZE (%s)' % task['size_expr']
+      elif declared < required:
+         status = 'UNDER'
+         under = True
+      elif declared < recommended:
+         status = 'LOW'
+      elif declared > recommended * args.over:
+         status = 'OVER (reclaim %d words)' % (declared - recommended)
+      else:
+         status = 'OK'
+
+      if problems:
+         status += ' [estimate is not reliable]'
+
+      print(fmt % (
+         task['body'],
+         '?' if declared is None else declared,
+         required, recommended, status
+         ))
+
+      if args.path:
+         print('   %s: %d bytes: %s' % (task['where'], size, ' -> '.join(path)))
+      for problem in sorted(problems):
+         print('   %s' % problem)
+
+   for cycle in sorted(analyzer.recursive):
+      warn('recursion: %s' % cycle)
+
+   return 1 if under else 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
@@ -0,0 +1,435 @@
+#!/usr/bin/env python3
+#
+# TNeo: system description compiler
+#
+# Reads a declarative description of the application objects (tasks, mutexes,
+# semaphores, event groups, data queues, memory pools and timers, and which
+# tasks use which objects), checks it, and generates C code which defines all
+# the objects along with their storage (stacks, FIFOs, pool buffers) and
+# creates them.
+#
+# Ceiling priorities of mutexes with the `ceiling` protocol are computed from
+# the declared lockers: the ceiling is the highest priority (the smallest
+# number) of all the tasks which lock the mutex. Explicitly given ceiling is
+# checked against the lockers instead.
+#
+# Kernel objects can't be initialized statically as a plain table: object
+# structures depend on the kernel configuration, and task stacks have to be
+# initialized by the arch code. So, the generated `<prefix>_objects_create()`
+# calls `tn_*_create()` in the right order, and it should be called from the
+# `#TN_CBUserTaskCreate` callback given to `tn_sys_start()`. Since all the
+# parameters are checked by this tool (and by the preprocessor checks in the
+# generated code), the application may build the kernel with
+# `TN_CHECK_PARAM` set to 0.
+#
+# Description is a JSON file:
+#
+#    {
+#       "prefix":   "app",
+#       "includes": ["app_msg.h"],
+#       "tasks": [
+#          {"name": "task_a", "func": "task_a_body", "priority": 3,
+#           "stack": 256, "start": true,
+#           "uses": ["mtx_data", "que_rx"]}
+#       ],
+#       "mutexes":    [{"name": "mtx_data", "protocol": "ceiling"}],
+#       "semaphores": [{"name": "sem_tx", "start_count": 0, "max_count": 1}],
+#       "eventgrps":  [{"name": "evt_io", "pattern": 0}],
+#       "queues":     [{"name": "que_rx", "items_cnt": 8}],
+#       "pools":      [{"name": "pool_msg", "item_type": "struct AppMsg",
+#                       "blocks_cnt": 8}],
+#       "timers":     [{"name": "tmr_led", "func": "tmr_led_cb",
+#                       "uses": ["sem_tx"]}]
+#    }
+#
+# Stack sizes are in words, as for `TN_STACK_ARR_DEF()`; a macro name (string)
+# may be given instead of a number. Optional fields: task "param" (C
+# expression, default `TN_NULL`), "start" (default true); mutex
+# "ceil_priority"; timer "user_data" (C expression, default `TN_NULL`).
+#
+# Usage example:
+#
+#    $ python3 tn_sysgen.py app_sys.json -o src/app_sys
+#
+# generates `src/app_sys.h` and `src/app_sys.c`.
+#
+# Exit status is 1 if the description is invalid, or 0 otherwise.
+#
+
+import argparse
+import json
+import os
+import re
+import sys
+
+
+#-- Object kinds: (key in the description, C type)
+KINDS = [
+   ('tasks',         'struct TN_Task'),
+   ('mutexes',       'struct TN_Mutex'),
+   ('semaphores',    'struct TN_Sem'),
+   ('eventgrps',     'struct TN_EventGrp'),
+   ('queues',        'struct TN_DQueue'),
+   ('pools',         'struct TN_FMem'),
+   ('timers',        'struct TN_Timer'),
+]
+
+MUTEX_PROTOCOLS = {
+   'ceiling':  'TN_MUTEX_PROT_CEILING',
+   'inherit':  'TN_MUTEX_PROT_INHERIT',
+}
+
+IDENT_RE = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+
+
+class DescError(Exception):
+   pass
+
+
+def check(cond, msg):
+   if not cond:
+      raise DescError(msg)
+
+
+def int_field(obj, key, default=None, min_value=None):
+   value = obj.get(key, default)
+   check(isinstance(value, int) and not isinstance(value, bool),
+         '%s: "%s" should be an integer' % (obj['name'], key))
+   if min_value is not None:
+      check(value >= min_value, '%s: "%s" should be >= %d'
+            % (obj['name'], key, min_value))
+   return value
+
+
+class System:
+   def __init__(self, desc, priorities_cnt):
+      self.prefix = desc.get('prefix', 'app')
+      check(IDENT_RE.match(self.prefix), 'wrong prefix "%s"' % self.prefix)
+
+      self.includes = desc.get('includes', [])
+      self.priorities_cnt = priorities_cnt
+
+      self.objs = {}
+      for kind, _ in KINDS:
+         self.objs[kind] = desc.get(kind, [])
+
+      unknown = set(desc) - set(k for k, _ in KINDS) \
+            - {'prefix', 'includes'}
+      check(not unknown, 'unknown sections: %s' % ', '.join(sorted(unknown)))
+
+      self.kind_by_name = {}
+      for kind, _ in KINDS:
+         for obj in self.objs[kind]:
+            name = obj.get('name')
+            check(isinstance(name, str) and IDENT_RE.match(name),
+                  '%s: wrong object name %r' % (kind, name))
+            check(name not in self.kind_by_name,
+                  '%s: duplicate name' % name)
+            self.kind_by_name[name] = kind
+
+      self._check_tasks()
+      self._check_objects()
+      self._compute_ceilings()
+
+   def _check_uses(self, obj, owner_kind):
+      uses = obj.get('uses', [])
+      for used in uses:
+         check(used in self.kind_by_name,
+               '%s: uses unknown object "%s"' % (obj['name'], used))
+         used_kind = self.kind_by_name[used]
+         check(used_kind not in ('tasks', 'timers') or owner_kind == 'tasks',
+               '%s: "uses" may refer to synchronization objects only'
+               % obj['name'])
+         #-- timer callbacks are called from ISR context
+         check(owner_kind != 'timers' or used_kind != 'mutexes',
+               '%s: mutex "%s" can\'t be used from timer callback'
+               % (obj['name'], used))
+      return uses
+
+   def _check_tasks(self):
+      for task in self.objs['tasks']:
+         func = task.get('func')
+         check(isinstance(func, str) and IDENT_RE.match(func),
+               '%s: wrong "func"' % task['name'])
+         #-- the lowest priority is reserved for the idle task
+         prio = int_field(task, 'priority', min_value=0)
+         check(prio < self.priorities_cnt - 1,
+               '%s: priority should be less than %d (TN_PRIORITIES_CNT - 1)'
+               % (task['name'], self.priorities_cnt - 1))
+         stack = task.get('stack')
+         check((isinstance(stack, int) and stack > 0)
+               or (isinstance(stack, str) and IDENT_RE.match(stack)),
+               '%s: "stack" should be a positive number or a macro name'
+               % task['name'])
+         self._check_uses(task, 'tasks')
+
+   def _check_objects(self):
+      for mutex in self.objs['mutexes']:
+         check(mutex.get('protocol') in MUTEX_PROTOCOLS,
+               '%s: "protocol" should be one of: %s'
+               % (mutex['name'], ', '.join(sorted(MUTEX_PROTOCOLS))))
+
+      for sem in self.objs['semaphores']:
+         start = int_field(sem, 'start_count', 0, min_value=0)
+         max_count = int_field(sem, 'max_count', min_value=1)
+         check(start <= max_count,
+               '%s: "start_count" exceeds "max_count"' % sem['name'])
+
+      for egrp in self.objs['eventgrps']:
+         int_field(egrp, 'pattern', 0, min_value=0)
+
+      for que in self.objs['queues']:
+         int_field(que, 'items_cnt', min_value=0)
+
+      for pool in self.objs['pools']:
+         check(isinstance(pool.get('item_type'), str),
+               '%s: "item_type" is required' % pool['name'])
+         int_field(pool, 'blocks_cnt', min_value=2)
+
+      for timer in self.objs['timers']:
+         func = timer.get('func')
+         check(isinstance(func, str) and IDENT_RE.match(func),
+               '%s: wrong "func"' % timer['name'])
+         self._check_uses(timer, 'timers')
+
+   def _compute_ceilings(self):
+      self.lockers = {m['name']: [] for m in self.objs['mutexes']}
+      for task in self.objs['tasks']:
+         for used in task.get('uses', []):
+            if used in self.lockers:
+               self.lockers[used].append(task)
+
+      self.ceilings = {}
+      for mutex in self.objs['mutexes']:
+         name = mutex['name']
+         if mutex['protocol'] != 'ceiling':
+            continue
+
+         prios = [t['priority'] for t in self.lockers[name]]
+         if 'ceil_priority' in mutex:
+            ceil = int_field(mutex, 'ceil_priority', min_value=0)
+            check(ceil < self.priorities_cnt - 1,
+                  '%s: "ceil_priority" should be less than %d'
+                  % (name, self.priorities_cnt - 1))
+            check(not prios or ceil <= min(prios),
+                  '%s: ceiling %d is lower than priority %d of the locker'
+                  % (name, ceil, min(prios)))
+         else:
+            check(prios, '%s: no lockers declared, can\'t compute ceiling'
+                  % name)
+            ceil = min(prios)
+         self.ceilings[name] = ceil
+
+   def warnings(self):
+      ret = []
+      used = set()
+      for kind in ('tasks', 'timers'):
+         for obj in self.objs[kind]:
+            used.update(obj.get('uses', []))
+      for kind, _ in KINDS:
+         if kind in ('tasks', 'timers'):
+            continue
+         for obj in self.objs[kind]:
+            if obj['name'] not in used:
+               ret.append('%s is not used by any task or timer' % obj['name'])
+      for name, ceil in sorted(self.ceilings.items()):
+         if len(self.lockers[name]) == 1:
+            ret.append('%s is locked by the single task %s'
+                  % (name, self.lockers[name][0]['name']))
+      return ret
+
+
+def macro(sys_, name, suffix):
+   return ('%s_%s_%s' % (sys_.prefix, name, suffix)).upper()
+
+
+def gen_header(sys_, basename):
+   guard = '_%s_H' % re.sub(r'[^A-Za-z0-9]', '_', basename).upper()
+   out = []
+   out.append('/*')
+   out.append(' * Generated by tn_sysgen.py, don\'t edit.')
+   out.append(' */')
+   out.append('')
+   out.append('#ifndef %s' % guard)
+   out.append('#define %s' % guard)
+   out.append('')
+   out.append('#include "tn.h"')
+   for inc in sys_.includes:
+      out.append('#include "%s"' % inc)
+   out.append('')
+
+   for task in sys_.objs['tasks']:
+      out.append('#define %-40s %d' % (
+         macro(sys_, task['name'], 'PRIORITY'), task['priority']))
+   for name, ceil in sorted(sys_.ceilings.items()):
+      out.append('#define %-40s %d' % (
+         macro(sys_, name, 'CEIL_PRIORITY'), ceil))
+   out.append('')
+
+   for kind, ctype in KINDS:
+      for obj in sys_.objs[kind]:
+         out.append('extern %s %s;' % (ctype, obj['name']))
+   out.append('')
+
+   for task in sys_.objs['tasks']:
+      out.append('void %s(void *param);' % task['func'])
+   for timer in sys_.objs['timers']:
+      out.append('void %s(struct TN_Timer *timer, void *p_user_data);'
+            % timer['func'])
+   out.append('')
+
+   out.append('/**')
+   out.append(' * Create all the objects of the system; should be called from '
+         'the')
+   out.append(' * `TN_CBUserTaskCreate` callback given to `tn_sys_start()`.')
+   out.append(' */')
+   out.append('enum TN_RCode %s_objects_create(void);' % sys_.prefix)
+   out.append('')
+   out.append('#endif // %s' % guard)
+   out.append('')
+   return '\n'.join(out)
+
+
+def gen_source(sys_, header_name):
+   out = []
+   out.append('/*')
+   out.append(' * Generated by tn_sysgen.py, don\'t edit.')
+   out.append(' */')
+   out.append('')
+   out.append('#include "%s"' % header_name)
+   out.append('')
+
+   #-- build-time checks of the things unknown to the tool
+   if sys_.objs['mutexes']:
+      out.append('#if !TN_USE_MUTEXES')
+      out.append('#  error TN_USE_MUTEXES should be non-zero')
+      out.append('#endif')
+   prios = [t['priority'] for t in sys_.objs['tasks']]
+   if prios:
+      out.append('#if TN_PRIORITIES_CNT <= %d' % (max(prios) + 1))
+      out.append('#  error TN_PRIORITIES_CNT is too small for the priorities '
+            'used')
+      out.append('#endif')
+   for task in sys_.objs['tasks']:
+      out.append('#if (%s) < TN_MIN_STACK_SIZE' % task['stack'])
+      out.append('#  error stack of %s is less than TN_MIN_STACK_SIZE'
+            % task['name'])
+      out.append('#endif')
+   out.append('')
+
+   #-- storage
+   for task in sys_.objs['tasks']:
+      out.append('TN_STACK_ARR_DEF(%s_stack, %s);'
+            % (task['name'], task['stack']))
+   for que in sys_.objs['queues']:
+      if que['items_cnt'] > 0:
+         out.append('static void *%s_fifo[ %d ];'
+               % (que['name'], que['items_cnt']))
+   for pool in sys_.objs['pools']:
+      out.append('static TN_FMEM_BUF_DEF(%s_buf, %s, %d);'
+            % (pool['name'], pool['item_type'], pool['blocks_cnt']))
+   out.append('')
+
+   for kind, ctype in KINDS:
+      for obj in sys_.objs[kind]:
+         out.append('%s %s;' % (ctype, obj['name']))
+   out.append('')
+
+   #-- creation; objects first, so that tasks could use them right away
+   out.append('enum TN_RCode %s_objects_create(void)' % sys_.prefix)
+   out.append('{')
+   out.append('   enum TN_RCode rc = TN_RC_OK;')
+   out.append('')
+
+   calls = []
+   for mutex in sys_.objs['mutexes']:
+      name = mutex['name']
+      ceil = (macro(sys_, name, 'CEIL_PRIORITY')
+            if name in sys_.ceilings else '0')
+      calls.append('tn_mutex_create(&%s, %s, %s)'
+            % (name, MUTEX_PROTOCOLS[mutex['protocol']], ceil))
+   for sem in sys_.objs['semaphores']:
+      calls.append('tn_sem_create(&%s, %d, %d)' % (
+         sem['name'], sem.get('start_count', 0), sem['max_count']))
+   for egrp in sys_.objs['eventgrps']:
+      calls.append('tn_eventgrp_create(&%s, 0x%x)'
+            % (egrp['name'], egrp.get('pattern', 0)))
+   for que in sys_.objs['queues']:
+      if que['items_cnt'] > 0:
+         calls.append('tn_queue_create(&%s, %s_fifo, %d)'
+               % (que['name'], que['name'], que['items_cnt']))
+      else:
+         calls.append('tn_queue_create(&%s, TN_NULL, 0)' % que['name'])
+   for pool in sys_.objs['pools']:
+      calls.append('tn_fmem_create(&%s, %s_buf, '
+            'TN_MAKE_ALIG_SIZE(sizeof(%s)), %d)' % (
+               pool['name'], pool['name'], pool['item_type'],
+               pool['blocks_cnt']))
+   for timer in sys_.objs['timers']:
+      calls.append('tn_timer_create(&%s, %s, %s)' % (
+         timer['name'], timer['func'], timer.get('user_data', 'TN_NULL')))
+   for task in sys_.objs['tasks']:
+      opts = ('TN_TASK_CREATE_OPT_START' if task.get('start', True)
+            else '(enum TN_TaskCreateOpt)0')
+      calls.append('tn_task_create_wname(\n'
+            '            &%s, %s, %s,\n'
+            '            %s_stack, (%s),\n'
+            '            %s, %s, "%s"\n'
+            '            )' % (
+               task['name'], task['func'],
+               macro(sys_, task['name'], 'PRIORITY'),
+               task['name'], task['stack'],
+               task.get('param', 'TN_NULL'), opts, task['name']))
+
+   for call in calls:
+      out.append('   if (rc == TN_RC_OK){')
+      out.append('      rc = %s;' % call)
+      out.append('   }')
+   out.append('')
+   out.append('   return rc;')
+   out.append('}')
+   out.append('')
+   return '\n'.join(out)
+
+
+def main():
+   p = argparse.ArgumentParser(
+         description='Generate C code with kernel objects from the system '
+         'description')
+   p.add_argument('desc', help='system description (JSON)')
+   p.add_argument('-o', '--output', required=True,
+         help='output path without extension: .h and .c are generated')
+   p.add_argument('--priorities-cnt', type=int, default=32,
+         help='value of TN_PRIORITIES_CNT (it is also checked at build '
+         'time by the generated code)')
+   p.add_argument('--check', action='store_true',
+         help='only check the description, don\'t generate anything')
+   args = p.parse_args()
+
+   with open(args.desc) as f:
+      desc = json.load(f)
+
+   try:
+      sys_ = System(desc, args.priorities_cnt)
+   except DescError as e:
+      sys.stderr.write('%s: error: %s\n' % (args.desc, e))
+      return 1
+
+   for msg in sys_.warnings():
+      sys.stderr.write('%s: warning: %s\n' % (args.desc, msg))
+
+   if not args.check:
+      basename = os.path.basename(args.output)
+      dirname = os.path.dirname(args.output)
+      if dirname:
+         os.makedirs(dirname, exist_ok=True)
+      with open(args.output + '.h', 'w') as f:
+         f.write(gen_header(sys_, basename))
+      with open(args.output + '.c', 'w') as f:
+         f.write(gen_source(sys_, basename + '.h'))
+
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())